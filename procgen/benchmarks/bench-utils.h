@@ -0,0 +1,74 @@
+#pragma once
+
+/*
+
+Helpers shared by the benchmarks and tools that build a VecGame directly instead of through libenv_make
+
+*/
+
+#include "../src/vecgame.h"
+#include "../src/vecoptions.h"
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+// libenv options that point into values owned by this struct, a deque never moves its elements as it grows
+struct Options {
+    std::deque<std::string> strings;
+    std::deque<std::vector<int32_t>> ints;
+    std::deque<uint8_t> bools;
+    std::vector<libenv_option> options;
+
+    Options() = default;
+    Options(const Options &) = delete;
+    Options &operator=(const Options &) = delete;
+
+    void add(const char *opt_name, libenv_dtype dtype, int count, void *data) {
+        libenv_option opt;
+        memset(&opt, 0, sizeof(opt));
+        strcpy(opt.name, opt_name);
+        opt.dtype = dtype;
+        opt.count = count;
+        opt.data = data;
+        options.push_back(opt);
+    }
+    void add_string(const char *opt_name, const std::string &value) {
+        strings.push_back(value);
+        add(opt_name, LIBENV_DTYPE_UINT8, (int)(strings.back().size()), (void *)(strings.back().c_str()));
+    }
+    void add_int(const char *opt_name, int32_t value) {
+        add_int_vector(opt_name, {value});
+    }
+    void add_int_vector(const char *opt_name, const std::vector<int32_t> &values) {
+        ints.push_back(values);
+        add(opt_name, LIBENV_DTYPE_INT32, (int)(values.size()), ints.back().data());
+    }
+    void add_bool(const char *opt_name, bool value) {
+        bools.push_back(value);
+        add(opt_name, LIBENV_DTYPE_UINT8, 1, &bools.back());
+    }
+
+    libenv_options get() {
+        libenv_options result;
+        result.items = options.data();
+        result.count = (int)(options.size());
+        return result;
+    }
+};
+
+// the options every benchmark sets, with a fixed rand_seed and the assets from the source tree
+inline void add_env_options(Options &opts, const std::string &env_name, int num_levels, int start_level, int num_threads) {
+    opts.add_string("env_name", env_name);
+    opts.add_int("num_levels", num_levels);
+    opts.add_int("start_level", start_level);
+    opts.add_int("num_actions", 15);
+    opts.add_int("num_threads", num_threads);
+    opts.add_int("rand_seed", 1);
+    opts.add_string("resource_root", PROCGEN_ASSETS_DIR);
+}
+
+inline std::shared_ptr<VecGame> make_venv(Options &opts, int num_envs) {
+    return std::make_shared<VecGame>(num_envs, VecOptions(opts.get()));
+}
@@ -0,0 +1,99 @@
+/*
+
+Measures the ways of finding the entities that overlap a query rect, for increasing entity counts
+
+scalar and simd run the same overlap_mask kernel over every entity, spatial_hash queries the broadphase
+(candidates still need the exact test). The simd results are checked against the scalar results.
+
+*/
+
+#include "../src/collision-kernels.h"
+#include "../src/cpp-utils.h"
+#include "../src/entity-store.h"
+#include "../src/randgen.h"
+#include "../src/spatial-hash.h"
+#include <chrono>
+#include <stdio.h>
+
+const int NUM_QUERIES = 20000;
+const float WORLD_DIM = 64;
+
+struct Query {
+    float x, y, r;
+};
+
+template <typename F>
+double time_queries(const std::vector<Query> &queries, F query, uint64_t *checksum) {
+    auto start = std::chrono::steady_clock::now();
+
+    for (const auto &q : queries) {
+        *checksum += query(q);
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return queries.size() / elapsed.count();
+}
+
+int main() {
+    uint64_t checksum = 0;
+
+    printf("%-8s %-8s %-14s %16s\n", "n", "impl", "method", "queries_per_sec");
+
+    for (int n : {7, 16, 37, 64, 256, 1024, 4096}) {
+        RandGen rand_gen;
+        rand_gen.seed(n);
+
+        std::vector<std::shared_ptr<Entity>> entities;
+        for (int i = 0; i < n; i++) {
+            float r = 0.25f + 0.5f * rand_gen.rand01();
+            entities.push_back(std::make_shared<Entity>(rand_gen.rand01() * WORLD_DIM, rand_gen.rand01() * WORLD_DIM, 0, 0, r, 0));
+        }
+
+        EntityStore store;
+        store.sync(entities);
+        SpatialHash spatial_hash;
+        spatial_hash.sync(store);
+
+        std::vector<Query> queries;
+        for (int i = 0; i < NUM_QUERIES; i++) {
+            queries.push_back(Query{rand_gen.rand01() * WORLD_DIM, rand_gen.rand01() * WORLD_DIM, 0.5f});
+        }
+
+        std::vector<uint64_t> hits((n + 63) / 64);
+        std::vector<uint64_t> scalar_hits((n + 63) / 64);
+        std::vector<int> indices;
+
+        auto mask_query = [&](const Query &q) {
+            overlap_mask(q.x, q.y, q.r, q.r, 0, store.x.data(), store.y.data(), store.rx.data(), store.ry.data(), n, hits.data());
+            indices.clear();
+            mask_to_indices_desc(hits.data(), n, indices);
+            return indices.size();
+        };
+
+        for (const auto &q : queries) {
+            set_overlap_mask_scalar(true);
+            overlap_mask(q.x, q.y, q.r, q.r, 0, store.x.data(), store.y.data(), store.rx.data(), store.ry.data(), n, scalar_hits.data());
+            set_overlap_mask_scalar(false);
+            overlap_mask(q.x, q.y, q.r, q.r, 0, store.x.data(), store.y.data(), store.rx.data(), store.ry.data(), n, hits.data());
+            fassert(hits == scalar_hits);
+        }
+
+        set_overlap_mask_scalar(true);
+        double scalar_rate = time_queries(queries, mask_query, &checksum);
+        set_overlap_mask_scalar(false);
+        double simd_rate = time_queries(queries, mask_query, &checksum);
+        double hash_rate = time_queries(queries, [&](const Query &q) {
+            spatial_hash.query(q.x, q.y, q.r, q.r, indices);
+            return indices.size();
+        }, &checksum);
+
+        printf("%-8d %-8s %-14s %16.0f\n", n, "scalar", "overlap_mask", scalar_rate);
+        printf("%-8d %-8s %-14s %16.0f\n", n, overlap_mask_impl(), "overlap_mask", simd_rate);
+        printf("%-8d %-8s %-14s %16.0f\n", n, "-", "spatial_hash", hash_rate);
+    }
+
+    // print the checksum so that the queries can't be optimized away
+    printf("checksum %llu\n", (unsigned long long)(checksum));
+
+    return 0;
+}
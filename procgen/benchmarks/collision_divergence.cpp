@@ -0,0 +1,147 @@
+/*
+
+Compares use_continuous_collision against the default sub-stepped collision over a corpus of level seeds
+
+Both modes play each level with the same pseudo-random actions until the episode ends in either mode.
+For every game this reports how many episodes ended with the same length, reward and level_complete, how
+many diverged (agent more than DIVERGENCE_DIST away from its position in the other mode, or a different
+reward or done on some step) and the median step of the first divergence.
+
+usage: collision_divergence [game ...] [--levels N] [--steps N] [--distribution-mode N]
+
+*/
+
+#include "../src/basic-abstract-game.h"
+#include "bench-utils.h"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+const float DIVERGENCE_DIST = 0.01f;
+
+struct Outcome {
+    int length = 0;
+    float reward = 0;
+    bool level_complete = false;
+};
+
+static std::shared_ptr<VecGame> make_venv(const std::string &game_name, int distribution_mode, bool continuous) {
+    Options opts;
+    add_env_options(opts, game_name, 1, 0, 0);
+    opts.add_int("distribution_mode", distribution_mode);
+    opts.add_bool("use_continuous_collision", continuous);
+    return make_venv(opts, 1);
+}
+
+static void play_level(Game *game, int level_seed) {
+    game->level_seed_low = level_seed;
+    game->level_seed_high = level_seed + 1;
+    game->episodes_remaining = 0;
+    game->reset();
+}
+
+int main(int argc, char **argv) {
+    std::vector<std::string> game_names;
+    int num_levels = 100;
+    int max_steps = 1000;
+    int distribution_mode = HardMode;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--levels" && i + 1 < argc) {
+            num_levels = atoi(argv[++i]);
+        } else if (arg == "--steps" && i + 1 < argc) {
+            max_steps = atoi(argv[++i]);
+        } else if (arg == "--distribution-mode" && i + 1 < argc) {
+            distribution_mode = atoi(argv[++i]);
+        } else {
+            game_names.push_back(arg);
+        }
+    }
+
+    if (game_names.empty()) {
+        for (const auto &kv : *globalGameRegistry) {
+            if (kv.first != "coinrun_old") {
+                game_names.push_back(kv.first);
+            }
+        }
+    }
+
+    printf("%-12s %8s %12s %10s %22s\n", "game", "episodes", "same_outcome", "diverged", "median_divergence_step");
+
+    for (const auto &game_name : game_names) {
+        auto discrete_venv = make_venv(game_name, distribution_mode, false);
+        auto continuous_venv = make_venv(game_name, distribution_mode, true);
+        Game *discrete = discrete_venv->games[0].get();
+        Game *continuous = continuous_venv->games[0].get();
+
+        auto discrete_basic = dynamic_cast<BasicAbstractGame *>(discrete);
+        auto continuous_basic = dynamic_cast<BasicAbstractGame *>(continuous);
+        if (discrete_basic == nullptr || continuous_basic == nullptr) {
+            printf("%-12s skipped, not a BasicAbstractGame\n", game_name.c_str());
+            continue;
+        }
+
+        // step() writes its reward and done here, they are read back from step_data instead
+        float rews[2];
+        uint8_t dones[2];
+        discrete->reward_ptr = &rews[0];
+        discrete->done_ptr = &dones[0];
+        continuous->reward_ptr = &rews[1];
+        continuous->done_ptr = &dones[1];
+
+        int same_outcome = 0;
+        std::vector<int> divergence_steps;
+
+        for (int level_seed = 0; level_seed < num_levels; level_seed++) {
+            play_level(discrete, level_seed);
+            play_level(continuous, level_seed);
+
+            Outcome outcomes[2];
+            bool done[2] = {false, false};
+            int divergence_step = -1;
+            uint32_t action_state = (uint32_t)(level_seed) * 2654435761u + 1;
+
+            for (int t = 0; t < max_steps && !done[0] && !done[1]; t++) {
+                action_state = action_state * 1103515245u + 12345u;
+                int act = (action_state >> 16) % 15;
+
+                Game *games[2] = {discrete, continuous};
+                for (int g = 0; g < 2; g++) {
+                    games[g]->action = act;
+                    games[g]->step();
+                    // step() resets finished episodes, so collect the outcome first
+                    outcomes[g].length = t + 1;
+                    outcomes[g].reward += games[g]->step_data.reward;
+                    outcomes[g].level_complete = outcomes[g].level_complete || games[g]->step_data.level_complete;
+                    done[g] = games[g]->step_data.done;
+                }
+
+                const auto &a0 = discrete_basic->get_agent();
+                const auto &a1 = continuous_basic->get_agent();
+                float dist = fabs(a0->x - a1->x) + fabs(a0->y - a1->y);
+                bool step_diverged = dist > DIVERGENCE_DIST || discrete->step_data.reward != continuous->step_data.reward || done[0] != done[1];
+
+                if (divergence_step < 0 && step_diverged) {
+                    divergence_step = t;
+                }
+            }
+
+            if (done[0] == done[1] && outcomes[0].length == outcomes[1].length && outcomes[0].reward == outcomes[1].reward && outcomes[0].level_complete == outcomes[1].level_complete) {
+                same_outcome++;
+            }
+
+            if (divergence_step >= 0) {
+                divergence_steps.push_back(divergence_step);
+            }
+        }
+
+        std::sort(divergence_steps.begin(), divergence_steps.end());
+        int median = divergence_steps.empty() ? -1 : divergence_steps[divergence_steps.size() / 2];
+
+        printf("%-12s %8d %12d %10d %22d\n", game_name.c_str(), num_levels, same_outcome, (int)(divergence_steps.size()), median);
+    }
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+/*
+
+Measures steps per second for games that keep many entities alive, where stepping and colliding the
+entities dominates the cost of a step
+
+Every env plays the same pseudo-random actions, 6 of the 15 actions fire, so starpilot and bossfight
+fill up with bullets. Resets at the end of an episode are included in the time.
+
+usage: entity_step_benchmark [game ...] [--envs N] [--steps N] [--distribution-mode N]
+
+*/
+
+#include "../src/game.h"
+#include "bench-utils.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+static std::shared_ptr<VecGame> make_venv(const std::string &env_name, int num_envs, int distribution_mode) {
+    Options opts;
+    add_env_options(opts, env_name, 0, 0, 0);
+    opts.add_int("distribution_mode", distribution_mode);
+
+    auto venv = make_venv(opts, num_envs);
+    for (const auto &game : venv->games) {
+        game->reset();
+    }
+    return venv;
+}
+
+int main(int argc, char **argv) {
+    std::vector<std::string> env_names;
+    int num_envs = 16;
+    int num_steps = 5000;
+    int distribution_mode = HardMode;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--envs" && i + 1 < argc) {
+            num_envs = atoi(argv[++i]);
+        } else if (arg == "--steps" && i + 1 < argc) {
+            num_steps = atoi(argv[++i]);
+        } else if (arg == "--distribution-mode" && i + 1 < argc) {
+            distribution_mode = atoi(argv[++i]);
+        } else {
+            env_names.push_back(arg);
+        }
+    }
+
+    if (env_names.empty()) {
+        env_names = {"starpilot", "bossfight"};
+    }
+
+    printf("%-10s %16s %10s\n", "env", "steps_per_sec", "episodes");
+
+    for (const auto &env_name : env_names) {
+        auto venv = make_venv(env_name, num_envs, distribution_mode);
+
+        std::vector<float> rews(num_envs);
+        std::vector<uint8_t> dones(num_envs);
+        for (int e = 0; e < num_envs; e++) {
+            venv->games[e]->reward_ptr = &rews[e];
+            venv->games[e]->done_ptr = &dones[e];
+        }
+
+        int episodes = 0;
+        uint32_t action_state = 1;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < num_steps; t++) {
+            for (int e = 0; e < num_envs; e++) {
+                action_state = action_state * 1103515245u + 12345u;
+                venv->games[e]->action = (action_state >> 16) % 15;
+                venv->games[e]->step();
+                episodes += dones[e];
+            }
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        printf("%-10s %16.0f %10d\n", env_name.c_str(), (double)(num_envs) * num_steps / elapsed.count(), episodes);
+    }
+
+    return 0;
+}
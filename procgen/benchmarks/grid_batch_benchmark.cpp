@@ -0,0 +1,107 @@
+/*
+
+Compares stepping maze envs one at a time through Game::step with stepping them all at once with GridBatch
+
+Both sets of envs are created with the same options and play the same pseudo-random actions, which
+include the -1 action that ends an episode. Every step the rewards, dones and agent cells of the two are
+compared, so mismatches should always be 0.
+
+usage: grid_batch_benchmark [--envs N] [--steps N] [--distribution-mode N]
+
+*/
+
+#include "../src/basic-abstract-game.h"
+#include "../src/grid-batch.h"
+#include "bench-utils.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+static std::shared_ptr<VecGame> make_venv(int num_envs, int distribution_mode) {
+    Options opts;
+    add_env_options(opts, "maze", 0, 0, 0);
+    opts.add_int("distribution_mode", distribution_mode);
+
+    auto venv = make_venv(opts, num_envs);
+    for (const auto &game : venv->games) {
+        game->reset();
+    }
+    return venv;
+}
+
+static void choose_actions(uint32_t *state, std::vector<int32_t> &actions) {
+    for (auto &act : actions) {
+        *state = *state * 1103515245u + 12345u;
+        act = (*state >> 16) % 1000 == 0 ? -1 : (*state >> 16) % 15;
+    }
+}
+
+int main(int argc, char **argv) {
+    int num_envs = 64;
+    int num_steps = 20000;
+    int distribution_mode = HardMode;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--envs") {
+            num_envs = atoi(argv[i + 1]);
+        } else if (arg == "--steps") {
+            num_steps = atoi(argv[i + 1]);
+        } else if (arg == "--distribution-mode") {
+            distribution_mode = atoi(argv[i + 1]);
+        }
+    }
+
+    auto single_venv = make_venv(num_envs, distribution_mode);
+    auto batch_venv = make_venv(num_envs, distribution_mode);
+    GridBatch batch(*batch_venv);
+
+    std::vector<int32_t> actions(num_envs);
+    std::vector<float> single_rews(num_envs), batch_rews(num_envs);
+    std::vector<uint8_t> single_dones(num_envs), batch_dones(num_envs), batch_level_completes(num_envs);
+
+    for (int e = 0; e < num_envs; e++) {
+        single_venv->games[e]->reward_ptr = &single_rews[e];
+        single_venv->games[e]->done_ptr = &single_dones[e];
+    }
+
+    double single_secs = 0;
+    double batch_secs = 0;
+    int mismatches = 0;
+    int episodes = 0;
+    uint32_t action_state = 1;
+
+    for (int t = 0; t < num_steps; t++) {
+        choose_actions(&action_state, actions);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int e = 0; e < num_envs; e++) {
+            single_venv->games[e]->action = actions[e];
+            single_venv->games[e]->step();
+        }
+        auto mid = std::chrono::steady_clock::now();
+        batch.step(actions.data(), nullptr, batch_rews.data(), batch_dones.data(), batch_level_completes.data());
+        auto end = std::chrono::steady_clock::now();
+
+        single_secs += std::chrono::duration<double>(mid - start).count();
+        batch_secs += std::chrono::duration<double>(end - mid).count();
+
+        for (int e = 0; e < num_envs; e++) {
+            auto game = dynamic_cast<BasicAbstractGame *>(single_venv->games[e].get());
+            int cell = game->get_agent_index();
+
+            if (single_rews[e] != batch_rews[e] || single_dones[e] != batch_dones[e] || cell != batch.agent_cell(e)) {
+                mismatches++;
+            }
+            episodes += single_dones[e];
+        }
+    }
+
+    double total_steps = (double)(num_envs) * num_steps;
+    printf("%-12s %16s\n", "method", "steps_per_sec");
+    printf("%-12s %16.0f\n", "game_step", total_steps / single_secs);
+    printf("%-12s %16.0f\n", "grid_batch", total_steps / batch_secs);
+    printf("episodes %d mismatches %d\n", episodes, mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
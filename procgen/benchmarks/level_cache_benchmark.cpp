@@ -0,0 +1,141 @@
+/*
+
+Measures level resets per second with and without the LevelCache on a bounded set of levels
+
+For every game that supports the cache, one set of envs resets and steps with level_cache_mb set and
+another without it, using the same seeds and actions. After every reset the grids and agent positions of
+the two are compared, as are the rewards and dones of every step, so mismatches should always be 0.
+
+usage: level_cache_benchmark [--envs N] [--levels N] [--resets N]
+
+*/
+
+#include "../src/basic-abstract-game.h"
+#include "../src/level-cache.h"
+#include "bench-utils.h"
+#include <chrono>
+#include <cstring>
+#include <stdio.h>
+#include <stdlib.h>
+
+static std::shared_ptr<VecGame> make_venv(const std::string &env_name, int num_envs, int num_levels, int level_cache_mb) {
+    Options opts;
+    add_env_options(opts, env_name, num_levels, 0, 0);
+    opts.add_int("level_cache_mb", level_cache_mb);
+    // generated assets draw a new background on every reset, which the cache does not support
+    opts.add_bool("use_generated_assets", false);
+    return make_venv(opts, num_envs);
+}
+
+static uint64_t level_hash(BasicAbstractGame *game) {
+    uint64_t hash = 14695981039346656037ULL;
+    auto add = [&hash](uint64_t value) {
+        hash = (hash ^ value) * 1099511628211ULL;
+    };
+
+    for (int i = 0; i < game->grid_size; i++) {
+        add((uint64_t)(game->get_obj(i)));
+    }
+    for (int i = 0; i < NUM_LEVEL_STATS; i++) {
+        add((uint64_t)(game->level_stats[i]));
+    }
+
+    const auto &agent = game->get_agent();
+    float pos[2] = {agent->x, agent->y};
+    uint32_t bits[2];
+    memcpy(bits, pos, sizeof(bits));
+    add(bits[0]);
+    add(bits[1]);
+
+    return hash;
+}
+
+int main(int argc, char **argv) {
+    int num_envs = 16;
+    int num_levels = 50;
+    int num_resets = 2000;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--envs") {
+            num_envs = atoi(argv[i + 1]);
+        } else if (arg == "--levels") {
+            num_levels = atoi(argv[i + 1]);
+        } else if (arg == "--resets") {
+            num_resets = atoi(argv[i + 1]);
+        }
+    }
+
+    int mismatches = 0;
+
+    printf("%-10s %16s %16s %10s\n", "env", "resets_per_sec", "cached_per_sec", "hit_rate");
+
+    for (std::string env_name : {"caveflyer", "heist", "maze"}) {
+        auto plain_venv = make_venv(env_name, num_envs, num_levels, 0);
+        auto cached_venv = make_venv(env_name, num_envs, num_levels, 256);
+        LevelCacheStats before = LevelCache::shared().stats();
+
+        double plain_secs = 0;
+        double cached_secs = 0;
+
+        for (int r = 0; r < num_resets; r++) {
+            int e = r % num_envs;
+            auto plain = dynamic_cast<BasicAbstractGame *>(plain_venv->games[e].get());
+            auto cached = dynamic_cast<BasicAbstractGame *>(cached_venv->games[e].get());
+
+            auto start = std::chrono::steady_clock::now();
+            plain->reset();
+            auto mid = std::chrono::steady_clock::now();
+            cached->reset();
+            auto end = std::chrono::steady_clock::now();
+
+            plain_secs += std::chrono::duration<double>(mid - start).count();
+            cached_secs += std::chrono::duration<double>(end - mid).count();
+
+            if (level_hash(plain) != level_hash(cached)) {
+                mismatches++;
+            }
+        }
+
+        LevelCacheStats after = LevelCache::shared().stats();
+        int64_t hits = after.hits - before.hits;
+        int64_t lookups = hits + after.misses - before.misses;
+
+        // play the same actions in both, episodes that start from a cached level must play out the same
+        std::vector<float> plain_rews(num_envs), cached_rews(num_envs);
+        std::vector<uint8_t> plain_dones(num_envs), cached_dones(num_envs);
+        uint32_t action_state = 1;
+
+        for (int e = 0; e < num_envs; e++) {
+            plain_venv->games[e]->reward_ptr = &plain_rews[e];
+            plain_venv->games[e]->done_ptr = &plain_dones[e];
+            cached_venv->games[e]->reward_ptr = &cached_rews[e];
+            cached_venv->games[e]->done_ptr = &cached_dones[e];
+        }
+
+        for (int t = 0; t < 2000; t++) {
+            for (int e = 0; e < num_envs; e++) {
+                action_state = action_state * 1103515245u + 12345u;
+                int act = (action_state >> 16) % 15;
+
+                auto plain = dynamic_cast<BasicAbstractGame *>(plain_venv->games[e].get());
+                auto cached = dynamic_cast<BasicAbstractGame *>(cached_venv->games[e].get());
+                plain->action = act;
+                cached->action = act;
+                plain->step();
+                cached->step();
+
+                if (plain_rews[e] != cached_rews[e] || plain_dones[e] != cached_dones[e] || level_hash(plain) != level_hash(cached)) {
+                    mismatches++;
+                }
+            }
+        }
+
+        printf("%-10s %16.0f %16.0f %10.3f\n", env_name.c_str(), num_resets / plain_secs, num_resets / cached_secs, lookups > 0 ? (double)(hits) / lookups : 0.0);
+    }
+
+    LevelCacheStats stats = LevelCache::shared().stats();
+    printf("levels %lld bytes %lld evictions %lld mismatches %d\n", (long long)(stats.levels), (long long)(stats.bytes), (long long)(stats.evictions), mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
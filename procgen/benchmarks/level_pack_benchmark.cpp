@@ -0,0 +1,156 @@
+/*
+
+Measures how fast level packs are written, and level resets per second with and without a level pack
+
+For every game that supports level packs, a pack of the levels [0, levels) is written to a temporary file,
+then one set of envs resets and steps reading levels from the pack and another generates them, using the
+same seeds and actions. After every reset the grids and agent positions of the two are compared, as are
+the rewards and dones of every step, so mismatches should always be 0.
+
+usage: level_pack_benchmark [--envs N] [--levels N] [--resets N] [--threads N]
+
+*/
+
+#include "../src/basic-abstract-game.h"
+#include "../src/level-pack.h"
+#include "bench-utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+
+static std::shared_ptr<VecGame> make_venv(const std::string &env_name, int num_envs, int num_levels, const std::string &level_pack) {
+    Options opts;
+    add_env_options(opts, env_name, num_levels, 0, 0);
+    if (!level_pack.empty()) {
+        opts.add_string("level_pack", level_pack);
+    }
+    // generated assets draw a new background on every reset, which level packs do not support
+    opts.add_bool("use_generated_assets", false);
+    return make_venv(opts, num_envs);
+}
+
+static uint64_t level_hash(BasicAbstractGame *game) {
+    uint64_t hash = 14695981039346656037ULL;
+    auto add = [&hash](uint64_t value) {
+        hash = (hash ^ value) * 1099511628211ULL;
+    };
+
+    for (int i = 0; i < game->grid_size; i++) {
+        add((uint64_t)(game->get_obj(i)));
+    }
+    for (int i = 0; i < NUM_LEVEL_STATS; i++) {
+        add((uint64_t)(game->level_stats[i]));
+    }
+
+    const auto &agent = game->get_agent();
+    float pos[2] = {agent->x, agent->y};
+    uint32_t bits[2];
+    memcpy(bits, pos, sizeof(bits));
+    add(bits[0]);
+    add(bits[1]);
+
+    return hash;
+}
+
+int main(int argc, char **argv) {
+    int num_envs = 16;
+    int num_levels = 50;
+    int num_resets = 2000;
+    int num_threads = (int)(std::thread::hardware_concurrency());
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--envs") {
+            num_envs = atoi(argv[i + 1]);
+        } else if (arg == "--levels") {
+            num_levels = atoi(argv[i + 1]);
+        } else if (arg == "--resets") {
+            num_resets = atoi(argv[i + 1]);
+        } else if (arg == "--threads") {
+            num_threads = atoi(argv[i + 1]);
+        }
+    }
+
+    int mismatches = 0;
+
+    num_threads = std::max(num_threads, 1);
+    std::string pack_path = (std::filesystem::temp_directory_path() / "level_pack_benchmark.pack").string();
+
+    printf("%-10s %16s %16s %16s\n", "env", "resets_per_sec", "packed_per_sec", "written_per_sec");
+
+    for (std::string env_name : {"caveflyer", "heist", "maze"}) {
+        double pack_secs;
+        {
+            auto pack_venv = make_venv(env_name, num_threads, num_levels, "");
+            auto start = std::chrono::steady_clock::now();
+            write_level_pack(pack_path, pack_venv->games, 0, num_levels);
+            pack_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        auto plain_venv = make_venv(env_name, num_envs, num_levels, "");
+        auto packed_venv = make_venv(env_name, num_envs, num_levels, pack_path);
+
+        double plain_secs = 0;
+        double packed_secs = 0;
+
+        for (int r = 0; r < num_resets; r++) {
+            int e = r % num_envs;
+            auto plain = dynamic_cast<BasicAbstractGame *>(plain_venv->games[e].get());
+            auto packed = dynamic_cast<BasicAbstractGame *>(packed_venv->games[e].get());
+
+            auto start = std::chrono::steady_clock::now();
+            plain->reset();
+            auto mid = std::chrono::steady_clock::now();
+            packed->reset();
+            auto end = std::chrono::steady_clock::now();
+
+            plain_secs += std::chrono::duration<double>(mid - start).count();
+            packed_secs += std::chrono::duration<double>(end - mid).count();
+
+            if (level_hash(plain) != level_hash(packed)) {
+                mismatches++;
+            }
+        }
+
+        // play the same actions in both, episodes that start from a packed level must play out the same
+        std::vector<float> plain_rews(num_envs), packed_rews(num_envs);
+        std::vector<uint8_t> plain_dones(num_envs), packed_dones(num_envs);
+        uint32_t action_state = 1;
+
+        for (int e = 0; e < num_envs; e++) {
+            plain_venv->games[e]->reward_ptr = &plain_rews[e];
+            plain_venv->games[e]->done_ptr = &plain_dones[e];
+            packed_venv->games[e]->reward_ptr = &packed_rews[e];
+            packed_venv->games[e]->done_ptr = &packed_dones[e];
+        }
+
+        for (int t = 0; t < 2000; t++) {
+            for (int e = 0; e < num_envs; e++) {
+                action_state = action_state * 1103515245u + 12345u;
+                int act = (action_state >> 16) % 15;
+
+                auto plain = dynamic_cast<BasicAbstractGame *>(plain_venv->games[e].get());
+                auto packed = dynamic_cast<BasicAbstractGame *>(packed_venv->games[e].get());
+                plain->action = act;
+                packed->action = act;
+                plain->step();
+                packed->step();
+
+                if (plain_rews[e] != packed_rews[e] || plain_dones[e] != packed_dones[e] || level_hash(plain) != level_hash(packed)) {
+                    mismatches++;
+                }
+            }
+        }
+
+        printf("%-10s %16.0f %16.0f %16.0f\n", env_name.c_str(), num_resets / plain_secs, num_resets / packed_secs, num_levels / pack_secs);
+    }
+
+    std::filesystem::remove(pack_path);
+    printf("mismatches %d\n", mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
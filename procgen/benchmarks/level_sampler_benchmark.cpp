@@ -0,0 +1,189 @@
+/*
+
+Measures LevelSampler against drawing levels with a linear scan over the scores
+
+naive is the O(n) reference, it draws the same random numbers as LevelSampler and scans for the level
+they select, so that the two can be checked to pick the same levels for the same seed. Score updates are
+pushed in batches the way an agent would push them after every rollout.
+
+*/
+
+#include "../src/level-sampler.h"
+#include "../src/randgen.h"
+#include "../src/cpp-utils.h"
+#include <chrono>
+#include <cmath>
+#include <stdio.h>
+
+const int UPDATE_BATCH = 256;
+const int SAMPLES_PER_UPDATE = 64;
+
+class NaiveSampler {
+  public:
+    NaiveSampler(int _num_levels, float _temperature, float _staleness)
+        : num_levels(_num_levels), temperature(_temperature), staleness(_staleness), weights(_num_levels, 1.0), last_sampled(_num_levels, 0) {
+    }
+
+    void update_scores(const int32_t *level_seeds, const float *scores, int count) {
+        for (int i = 0; i < count; i++) {
+            weights[level_seeds[i]] = std::pow((double)(scores[i]), 1.0 / temperature);
+        }
+    }
+
+    int sample(RandGen &rand_gen) {
+        double total_weight = 0;
+        int64_t total_staleness = 0;
+        for (int i = 0; i < num_levels; i++) {
+            total_weight += weights[i];
+            total_staleness += num_samples - last_sampled[i];
+        }
+
+        bool use_staleness = staleness > 0 && total_staleness > 0 && (staleness >= 1 || rand_gen.rand01() < staleness);
+
+        int level = num_levels - 1;
+        if (use_staleness) {
+            double u = rand_gen.rand01() * (double)(total_staleness);
+            for (int i = 0; i < num_levels; i++) {
+                u -= (double)(num_samples - last_sampled[i]);
+                if (u < 0) {
+                    level = i;
+                    break;
+                }
+            }
+        } else if (total_weight > 0) {
+            double u = rand_gen.rand01() * total_weight;
+            for (int i = 0; i < num_levels; i++) {
+                u -= weights[i];
+                if (u < 0) {
+                    level = i;
+                    break;
+                }
+            }
+        } else {
+            level = rand_gen.randn(num_levels);
+        }
+
+        num_samples++;
+        last_sampled[level] = num_samples;
+        return level;
+    }
+
+  private:
+    int num_levels;
+    float temperature;
+    float staleness;
+    std::vector<double> weights;
+    std::vector<int64_t> last_sampled;
+    int64_t num_samples = 0;
+};
+
+struct Batch {
+    std::vector<int32_t> seeds;
+    std::vector<float> scores;
+};
+
+static std::vector<Batch> make_batches(int num_levels, int num_batches) {
+    RandGen rand_gen;
+    rand_gen.seed(1);
+
+    std::vector<Batch> batches(num_batches);
+    for (auto &batch : batches) {
+        for (int i = 0; i < UPDATE_BATCH; i++) {
+            batch.seeds.push_back(rand_gen.randn(num_levels));
+            // skewed so that a few levels have most of the weight
+            float x = rand_gen.rand01();
+            batch.scores.push_back(x * x * x);
+        }
+    }
+    return batches;
+}
+
+template <typename Sampler>
+double run(Sampler &sampler, const std::vector<Batch> &batches, std::vector<int> *levels) {
+    RandGen rand_gen;
+    rand_gen.seed(2);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (const auto &batch : batches) {
+        sampler.update_scores(batch.seeds.data(), batch.scores.data(), UPDATE_BATCH);
+        for (int i = 0; i < SAMPLES_PER_UPDATE; i++) {
+            levels->push_back(sampler.sample(rand_gen));
+        }
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return batches.size() / elapsed.count();
+}
+
+/*
+  Checks the empirical distribution of a sampler with fixed scores against the expected probabilities,
+  returning the largest absolute difference
+*/
+static double max_distribution_error(float temperature) {
+    const int num_levels = 8;
+    const int num_draws = 1000000;
+
+    std::vector<int32_t> seeds;
+    std::vector<float> scores;
+    double total = 0;
+    for (int i = 0; i < num_levels; i++) {
+        seeds.push_back(100 + i);
+        scores.push_back((float)(i));
+        total += std::pow((double)(i), 1.0 / temperature);
+    }
+
+    LevelSampler sampler(100, num_levels, temperature, 0.0f);
+    sampler.update_scores(seeds.data(), scores.data(), num_levels);
+
+    RandGen rand_gen;
+    rand_gen.seed(3);
+    std::vector<int> counts(num_levels, 0);
+    for (int i = 0; i < num_draws; i++) {
+        counts[sampler.sample(rand_gen) - 100]++;
+    }
+
+    double max_error = 0;
+    for (int i = 0; i < num_levels; i++) {
+        double expected = std::pow((double)(i), 1.0 / temperature) / total;
+        max_error = std::max(max_error, std::abs((double)(counts[i]) / num_draws - expected));
+    }
+    fassert(counts[0] == 0);
+    return max_error;
+}
+
+int main() {
+    for (float temperature : {1.0f, 0.5f, 2.0f}) {
+        double max_error = max_distribution_error(temperature);
+        printf("temperature %.1f: max probability error %.5f\n", temperature, max_error);
+        fassert(max_error < 0.005);
+    }
+    printf("\n");
+
+    printf("%-10s %-10s %14s %14s %10s %12s\n", "levels", "staleness", "naive_per_sec", "tree_per_sec", "speedup", "mismatches");
+
+    for (int num_levels : {1000, 10000, 100000}) {
+        for (float staleness : {0.0f, 0.1f}) {
+            int num_batches = std::max(20, 2000000 / num_levels);
+            auto batches = make_batches(num_levels, num_batches);
+
+            NaiveSampler naive(num_levels, 0.5f, staleness);
+            LevelSampler tree(0, num_levels, 0.5f, staleness);
+
+            std::vector<int> naive_levels;
+            std::vector<int> tree_levels;
+            double naive_rate = run(naive, batches, &naive_levels);
+            double tree_rate = run(tree, batches, &tree_levels);
+
+            // the sums are added in a different order, so rarely a draw on the boundary of two levels can differ
+            int mismatches = 0;
+            for (size_t i = 0; i < naive_levels.size(); i++) {
+                mismatches += naive_levels[i] != tree_levels[i];
+            }
+
+            printf("%-10d %-10.1f %14.0f %14.0f %9.1fx %12d\n", num_levels, staleness, naive_rate * SAMPLES_PER_UPDATE, tree_rate * SAMPLES_PER_UPDATE, tree_rate / naive_rate, mismatches);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,233 @@
+/*
+
+Measures evaluating every level of a bounded set with use_level_sweep against a static assignment of levels
+
+static splits the levels evenly between envs ahead of time, the way it had to be done from Python: each env
+starts its next level with reset_to_seeds when an episode ends, and max_episodes_per_game stops it once its
+share is played. sweep lets the envs claim levels as they finish episodes.
+
+util is the fraction of env slots in all step batches that played a level. Batches with fewer active envs
+than threads leave threads idle, so util matters more than the times on machines with few cores.
+
+Both play the same actions for the same level and step, so the return, length and level_complete of every
+level are compared and mismatches should always be 0.
+
+usage: level_sweep_benchmark [--envs N] [--threads N] [--levels N]
+
+*/
+
+#include "../src/game.h"
+#include "../src/level-sweep.h"
+#include "bench-utils.h"
+#include <chrono>
+#include <cstring>
+#include <stdio.h>
+#include <stdlib.h>
+
+static std::shared_ptr<VecGame> make_venv(const std::string &env_name, int num_envs, int num_threads, int num_levels, bool use_level_sweep, const std::vector<int32_t> &max_episodes) {
+    Options opts;
+    add_env_options(opts, env_name, num_levels, 0, num_threads);
+    opts.add_int_vector("max_episodes_per_game", max_episodes);
+    opts.add_bool("use_level_sweep", use_level_sweep);
+    return make_venv(opts, num_envs);
+}
+
+// one buffer per env for each space
+struct SpaceBuffers {
+    std::vector<std::vector<uint8_t>> storage;
+    std::vector<std::vector<void *>> bufs;
+
+    SpaceBuffers(int num_envs, const std::vector<struct libenv_space> &spaces) {
+        storage.resize(num_envs * spaces.size());
+        bufs.resize(num_envs);
+        for (int e = 0; e < num_envs; e++) {
+            for (size_t s = 0; s < spaces.size(); s++) {
+                // 4 bytes per element is enough for every dtype
+                size_t size = 4;
+                for (int d = 0; d < spaces[s].ndim; d++) {
+                    size *= spaces[s].shape[d];
+                }
+                auto &buf = storage[e * spaces.size() + s];
+                buf.resize(size);
+                bufs[e].push_back(buf.data());
+            }
+        }
+    }
+};
+
+struct Results {
+    std::vector<float> returns;
+    std::vector<int32_t> lengths;
+    std::vector<uint8_t> level_completes;
+    int batches = 0;
+    double secs = 0;
+};
+
+// the action only depends on the level and the step of the episode, so both runs play each level the same way
+static int policy(const Game &game) {
+    uint32_t x = (uint32_t)(game.current_level_seed) * 2654435761u + (uint32_t)(game.cur_time) * 40503u;
+    x ^= x >> 15;
+    x *= 2246822519u;
+    x ^= x >> 13;
+    return (int)(x % 15);
+}
+
+static int find_space(const std::vector<struct libenv_space> &spaces, const char *name) {
+    for (size_t s = 0; s < spaces.size(); s++) {
+        if (strcmp(spaces[s].name, name) == 0) {
+            return (int)(s);
+        }
+    }
+    fatal("missing space %s\n", name);
+    return -1;
+}
+
+static bool all_done(VecGame &venv) {
+    for (bool done : venv.all_episodes_done()) {
+        if (!done) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static Results run_sweep(const std::string &env_name, int num_envs, int num_threads, int num_levels) {
+    auto venv = make_venv(env_name, num_envs, num_threads, num_levels, true, std::vector<int32_t>(num_envs, 0));
+    SpaceBuffers obs(num_envs, venv->observation_spaces);
+    SpaceBuffers infos(num_envs, venv->info_spaces);
+    std::vector<float> rews(num_envs);
+    std::vector<uint8_t> dones(num_envs);
+    std::vector<int32_t> acts(num_envs);
+
+    Results results;
+    auto start = std::chrono::steady_clock::now();
+
+    venv->reset(obs.bufs);
+    while (!all_done(*venv)) {
+        for (int e = 0; e < num_envs; e++) {
+            acts[e] = policy(*venv->games[e]);
+        }
+        venv->step_async(acts, obs.bufs, infos.bufs, rews.data(), dones.data());
+        venv->step_wait();
+        results.batches++;
+    }
+
+    results.secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    results.returns = venv->level_sweep->returns;
+    results.lengths = venv->level_sweep->lengths;
+    results.level_completes = venv->level_sweep->level_completes;
+    return results;
+}
+
+static Results run_static(const std::string &env_name, int num_envs, int num_threads, int num_levels) {
+    // env e plays levels e, e + num_envs, ...
+    std::vector<int32_t> max_episodes(num_envs);
+    for (int e = 0; e < num_envs; e++) {
+        max_episodes[e] = (num_levels - e + num_envs - 1) / num_envs;
+    }
+
+    auto venv = make_venv(env_name, num_envs, num_threads, 0, false, max_episodes);
+    SpaceBuffers obs(num_envs, venv->observation_spaces);
+    SpaceBuffers infos(num_envs, venv->info_spaces);
+    std::vector<float> rews(num_envs);
+    std::vector<uint8_t> dones(num_envs);
+    std::vector<int32_t> acts(num_envs);
+    int level_complete_space = find_space(venv->info_spaces, "level_complete");
+
+    Results results;
+    results.returns.resize(num_levels, 0.0f);
+    results.lengths.resize(num_levels, -1);
+    results.level_completes.resize(num_levels, 0);
+
+    std::vector<int> episodes(num_envs, 0);
+    std::vector<float> episode_returns(num_envs, 0.0f);
+    std::vector<int> episode_lengths(num_envs, 0);
+    auto start = std::chrono::steady_clock::now();
+
+    venv->reset(obs.bufs);
+    std::vector<int32_t> seeds(num_envs, -1);
+    for (int e = 0; e < num_envs; e++) {
+        seeds[e] = e < num_levels ? e : -1;
+    }
+    venv->reset_to_seeds(seeds, obs.bufs);
+
+    while (!all_done(*venv)) {
+        for (int e = 0; e < num_envs; e++) {
+            acts[e] = policy(*venv->games[e]);
+            // envs that are no longer stepped keep their last done
+            dones[e] = 0;
+        }
+        venv->step_async(acts, obs.bufs, infos.bufs, rews.data(), dones.data());
+        venv->step_wait();
+        results.batches++;
+
+        for (int e = 0; e < num_envs; e++) {
+            seeds[e] = -1;
+            // envs that played their share were not stepped
+            if (episodes[e] >= max_episodes[e]) {
+                continue;
+            }
+            episode_returns[e] += rews[e];
+            episode_lengths[e]++;
+            if (dones[e]) {
+                int level = e + episodes[e] * num_envs;
+                results.returns[level] = episode_returns[e];
+                results.lengths[level] = episode_lengths[e];
+                results.level_completes[level] = *(uint8_t *)(infos.bufs[e][level_complete_space]);
+                episode_returns[e] = 0;
+                episode_lengths[e] = 0;
+                episodes[e]++;
+                if (episodes[e] < max_episodes[e]) {
+                    seeds[e] = level + num_envs;
+                }
+            }
+        }
+        venv->reset_to_seeds(seeds, obs.bufs);
+    }
+
+    results.secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return results;
+}
+
+int main(int argc, char **argv) {
+    int num_envs = 32;
+    int num_threads = 4;
+    int num_levels = 500;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--envs") {
+            num_envs = atoi(argv[i + 1]);
+        } else if (arg == "--threads") {
+            num_threads = atoi(argv[i + 1]);
+        } else if (arg == "--levels") {
+            num_levels = atoi(argv[i + 1]);
+        }
+    }
+
+    int mismatches = 0;
+
+    printf("%-10s %14s %14s %12s %12s %12s %12s\n", "env", "static_batches", "sweep_batches", "static_util", "sweep_util", "static_secs", "sweep_secs");
+
+    for (std::string env_name : {"bigfish", "coinrun", "heist", "maze"}) {
+        Results static_results = run_static(env_name, num_envs, num_threads, num_levels);
+        Results sweep_results = run_sweep(env_name, num_envs, num_threads, num_levels);
+
+        int64_t steps = 0;
+        for (int i = 0; i < num_levels; i++) {
+            steps += sweep_results.lengths[i];
+            if (static_results.lengths[i] < 0 || static_results.returns[i] != sweep_results.returns[i] || static_results.lengths[i] != sweep_results.lengths[i] || static_results.level_completes[i] != sweep_results.level_completes[i]) {
+                mismatches++;
+            }
+        }
+
+        // the fraction of env slots in all batches that stepped a level, the rest leave threads idle
+        double static_util = (double)(steps) / ((double)(static_results.batches) * num_envs);
+        double sweep_util = (double)(steps) / ((double)(sweep_results.batches) * num_envs);
+        printf("%-10s %14d %14d %12.3f %12.3f %12.3f %12.3f\n", env_name.c_str(), static_results.batches, sweep_results.batches, static_util, sweep_util, static_results.secs, sweep_results.secs);
+    }
+
+    printf("mismatches %d\n", mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+/*
+
+Measures level generation throughput of every registered game in every distribution mode it supports
+
+Each game is reset repeatedly on new levels without stepping, and the time of every reset is broken down by
+the phases in levelgen-profile.h. The sources are compiled with PROCGEN_PROFILE_LEVELGEN for this target only,
+so the library itself has no timers.
+
+The results are written as JSON to the --out file, with one entry per game and mode that holds levels per
+second and the mean microseconds per reset spent in each phase, and a summary table is printed to stdout.
+
+usage: levelgen_benchmark [--out PATH] [--resets N] [--env NAME] [--use-generated-assets]
+                          [--use-fast-level-generation]
+
+*/
+
+#include "../src/game.h"
+#include "../src/levelgen-profile.h"
+#include "bench-utils.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+struct ModeName {
+    DistributionMode mode;
+    const char *name;
+};
+
+const ModeName DISTRIBUTION_MODES[] = {{EasyMode, "easy"}, {HardMode, "hard"}, {ExtremeMode, "extreme"}, {MemoryMode, "memory"}};
+
+const int WARMUP_RESETS = 5;
+
+static std::shared_ptr<VecGame> make_venv(const std::string &env_name, DistributionMode mode, bool use_generated_assets, bool use_fast_level_generation) {
+    Options opts;
+    add_env_options(opts, env_name, 0, 0, 0);
+    opts.add_int("distribution_mode", mode);
+    opts.add_bool("use_generated_assets", use_generated_assets);
+    opts.add_bool("use_fast_level_generation", use_fast_level_generation);
+    return make_venv(opts, 1);
+}
+
+int main(int argc, char **argv) {
+    int num_resets = 200;
+    std::string out_path = "levelgen_benchmark.json";
+    std::string only_env;
+    bool use_generated_assets = false;
+    bool use_fast_level_generation = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--use-generated-assets") {
+            use_generated_assets = true;
+        } else if (arg == "--use-fast-level-generation") {
+            use_fast_level_generation = true;
+        } else if (arg == "--resets" && has_value) {
+            num_resets = atoi(argv[++i]);
+        } else if (arg == "--out" && has_value) {
+            out_path = argv[++i];
+        } else if (arg == "--env" && has_value) {
+            only_env = argv[++i];
+        } else {
+            fatal("unknown argument %s\n", arg.c_str());
+        }
+    }
+    fassert(num_resets > 0);
+
+    // the registry is sorted by name, so the output order is stable
+    std::vector<std::string> env_names;
+    for (const auto &kv : *globalGameRegistry) {
+        if (only_env.empty() || kv.first == only_env) {
+            env_names.push_back(kv.first);
+        }
+    }
+    if (env_names.empty()) {
+        fatal("unknown env %s\n", only_env.c_str());
+    }
+
+    FILE *json = fopen(out_path.c_str(), "w");
+    if (json == nullptr) {
+        fatal("failed to open %s for writing\n", out_path.c_str());
+    }
+
+    printf("%-12s %-8s %14s", "env", "mode", "levels_per_sec");
+    for (int p = 0; p < NUM_LEVELGEN_PHASES; p++) {
+        printf(" %12s", LEVELGEN_PHASE_NAMES[p]);
+    }
+    printf("\n");
+
+    fprintf(json, "{\n");
+    fprintf(json, "  \"benchmark\": \"levelgen\",\n");
+    fprintf(json, "  \"resets\": %d,\n", num_resets);
+    fprintf(json, "  \"use_generated_assets\": %s,\n", use_generated_assets ? "true" : "false");
+    fprintf(json, "  \"use_fast_level_generation\": %s,\n", use_fast_level_generation ? "true" : "false");
+    fprintf(json, "  \"results\": [");
+
+    bool first_result = true;
+    for (const auto &env_name : env_names) {
+        for (const auto &mode : DISTRIBUTION_MODES) {
+            if (!supports_distribution_mode(env_name, mode.mode)) {
+                continue;
+            }
+
+            auto venv = make_venv(env_name, mode.mode, use_generated_assets, use_fast_level_generation);
+            const auto &game = venv->games[0];
+
+            for (int r = 0; r < WARMUP_RESETS; r++) {
+                game->reset();
+            }
+
+            auto &profile = levelgen_profile();
+            for (int p = 0; p < NUM_LEVELGEN_PHASES; p++) {
+                profile.seconds[p] = 0;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            for (int r = 0; r < num_resets; r++) {
+                LevelGenTimer timer(LEVELGEN_OTHER);
+                game->reset();
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            double levels_per_sec = num_resets / elapsed.count();
+
+            printf("%-12s %-8s %14.0f", env_name.c_str(), mode.name, levels_per_sec);
+            for (int p = 0; p < NUM_LEVELGEN_PHASES; p++) {
+                printf(" %12.1f", profile.seconds[p] * 1e6 / num_resets);
+            }
+            printf("\n");
+
+            fprintf(json, "%s\n    {\"env\": \"%s\", \"distribution_mode\": \"%s\", \"levels_per_sec\": %.1f, \"mean_reset_us\": %.3f, \"phases_us\": {", first_result ? "" : ",", env_name.c_str(), mode.name, levels_per_sec, elapsed.count() * 1e6 / num_resets);
+            for (int p = 0; p < NUM_LEVELGEN_PHASES; p++) {
+                fprintf(json, "%s\"%s\": %.3f", p > 0 ? ", " : "", LEVELGEN_PHASE_NAMES[p], profile.seconds[p] * 1e6 / num_resets);
+            }
+            fprintf(json, "}}");
+            first_result = false;
+        }
+    }
+
+    fprintf(json, "\n  ]\n}\n");
+    if (fclose(json) != 0) {
+        fatal("failed to write %s\n", out_path.c_str());
+    }
+    printf("wrote %s\n", out_path.c_str());
+
+    return 0;
+}
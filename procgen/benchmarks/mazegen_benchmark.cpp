@@ -0,0 +1,150 @@
+/*
+
+Measures how many mazes per second MazeGen::generate_maze produces at several maze sizes
+
+legacy is the previous std::set based kruskal's algorithm, which is kept here as a reference so that the
+stream compatible union-find version can be checked to produce identical mazes for the same seed.
+shuffle is the union-find version with stream_compatible cleared, as used by use_fast_level_generation.
+
+*/
+
+#include "../src/mazegen.h"
+#include "../src/object-ids.h"
+#include "../src/cpp-utils.h"
+#include <chrono>
+#include <set>
+#include <stdio.h>
+
+const int NUM_MAZES = 2000;
+
+// returns the maze as WALL_OBJ or SPACE for each of the maze_dim * maze_dim cells
+std::vector<int> legacy_generate_maze(RandGen &rand_gen, int maze_dim) {
+    struct Wall {
+        int x1;
+        int y1;
+        int x2;
+        int y2;
+    };
+
+    std::vector<int> cells(maze_dim * maze_dim, WALL_OBJ);
+    std::vector<std::set<int>> cell_sets(maze_dim * maze_dim);
+    std::vector<int> cell_sets_idxs(maze_dim * maze_dim);
+    std::vector<Wall> walls;
+
+    cells[0] = 0;
+
+    for (int i = 0; i < maze_dim * maze_dim; i++) {
+        cell_sets[i].insert(i);
+        cell_sets_idxs[i] = i;
+    }
+
+    for (int i = 1; i < maze_dim - 1; i += 2) {
+        for (int j = 0; j < maze_dim; j += 2) {
+            walls.push_back(Wall({i - 1, j, i + 1, j}));
+        }
+    }
+
+    for (int i = 0; i < maze_dim; i += 2) {
+        for (int j = 1; j < maze_dim - 1; j += 2) {
+            walls.push_back(Wall({i, j - 1, i, j + 1}));
+        }
+    }
+
+    while (walls.size() > 0) {
+        int n = rand_gen.randn((int)(walls.size()));
+        Wall wall = walls[n];
+
+        int s0_idx = cell_sets_idxs[maze_dim * wall.y1 + wall.x1];
+        int s1_idx = cell_sets_idxs[maze_dim * wall.y2 + wall.x2];
+        int center = maze_dim * ((wall.y1 + wall.y2) / 2) + (wall.x1 + wall.x2) / 2;
+
+        if (cells[center] == WALL_OBJ && s0_idx != s1_idx) {
+            cells[maze_dim * wall.y1 + wall.x1] = SPACE;
+            cells[center] = SPACE;
+            cells[maze_dim * wall.y2 + wall.x2] = SPACE;
+
+            std::set<int> &s0 = cell_sets[s0_idx];
+            std::set<int> &s1 = cell_sets[s1_idx];
+            s1.insert(s0.begin(), s0.end());
+            s1.insert(center);
+
+            for (int c : s1) {
+                cell_sets_idxs[c] = s1_idx;
+            }
+        }
+
+        walls.erase(walls.begin() + n);
+    }
+
+    return cells;
+}
+
+std::vector<int> maze_cells(MazeGen &maze_gen, int maze_dim) {
+    std::vector<int> cells(maze_dim * maze_dim);
+
+    for (int y = 0; y < maze_dim; y++) {
+        for (int x = 0; x < maze_dim; x++) {
+            cells[maze_dim * y + x] = maze_gen.grid.get(x + MAZE_OFFSET, y + MAZE_OFFSET);
+        }
+    }
+
+    return cells;
+}
+
+template <typename F>
+double time_mazes(F generate) {
+    auto start = std::chrono::steady_clock::now();
+
+    for (int seed = 0; seed < NUM_MAZES; seed++) {
+        generate(seed);
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return NUM_MAZES / elapsed.count();
+}
+
+int main() {
+    uint32_t checksum = 0;
+
+    printf("%-10s %-10s %16s\n", "maze_dim", "method", "mazes_per_sec");
+
+    for (int maze_dim : {15, 25, 51, 101}) {
+        RandGen rand_gen;
+        MazeGen maze_gen(&rand_gen, maze_dim);
+
+        for (int seed = 0; seed < 20; seed++) {
+            rand_gen.seed(seed);
+            std::vector<int> expected = legacy_generate_maze(rand_gen, maze_dim);
+            rand_gen.seed(seed);
+            maze_gen.generate_maze();
+            fassert(maze_cells(maze_gen, maze_dim) == expected);
+        }
+
+        double rates[3];
+        rates[0] = time_mazes([&](int seed) {
+            rand_gen.seed(seed);
+            checksum += legacy_generate_maze(rand_gen, maze_dim)[maze_dim];
+        });
+        rates[1] = time_mazes([&](int seed) {
+            rand_gen.seed(seed);
+            maze_gen.generate_maze();
+            checksum += maze_gen.grid.get(MAZE_OFFSET, MAZE_OFFSET + 1);
+        });
+        rand_gen.stream_compatible = false;
+        rates[2] = time_mazes([&](int seed) {
+            rand_gen.seed(seed);
+            maze_gen.generate_maze();
+            checksum += maze_gen.grid.get(MAZE_OFFSET, MAZE_OFFSET + 1);
+        });
+
+        const char *names[] = {"legacy", "union_find", "shuffle"};
+        for (int m = 0; m < 3; m++) {
+            printf("%-10d %-10s %16.0f\n", maze_dim, names[m], rates[m]);
+        }
+    }
+
+    // print the checksum so that the mazes can't be optimized away
+    printf("checksum %u\n", checksum);
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+/*
+
+Measures how quickly RandGen can be reseeded, which happens on every level reset, for each backend
+
+Each reset reseeds the generator with the level seed and then draws the numbers used to generate
+the level, so both the cost of seeding alone and of seeding followed by a typical number of draws
+are reported.
+
+*/
+
+#include "../src/randgen.h"
+#include <chrono>
+#include <stdio.h>
+
+const int NUM_RESETS = 200000;
+
+double time_resets(RandGenBackend backend, int draws_per_reset, uint32_t *checksum) {
+    RandGen rand_gen;
+    rand_gen.set_backend(backend);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < NUM_RESETS; i++) {
+        rand_gen.seed(i);
+        for (int j = 0; j < draws_per_reset; j++) {
+            *checksum += rand_gen.randint();
+        }
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return NUM_RESETS / elapsed.count();
+}
+
+int main() {
+    const char *backend_names[] = {"mt19937", "pcg32"};
+    RandGenBackend backends[] = {MT19937Backend, PCG32Backend};
+    int draws[] = {0, 100, 1000};
+    uint32_t checksum = 0;
+
+    printf("%-10s %-16s %16s\n", "backend", "draws_per_reset", "resets_per_sec");
+
+    for (int b = 0; b < 2; b++) {
+        for (int d : draws) {
+            double rate = time_resets(backends[b], d, &checksum);
+            printf("%-10s %-16d %16.0f\n", backend_names[b], d, rate);
+        }
+    }
+
+    {
+        RandGen rand_gen;
+        rand_gen.set_backend(PCG32Backend);
+        rand_gen.seed(0);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < NUM_RESETS; i++) {
+            rand_gen.advance(1000000007ULL + i);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        printf("%-10s %-16s %16.0f\n", "pcg32", "advance", NUM_RESETS / elapsed.count());
+        checksum += rand_gen.randint();
+    }
+
+    // print the checksum so that the draws can't be optimized away
+    printf("checksum %u\n", checksum);
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+/*
+
+Measures evaluating a list of level seeds with VecGame::reset_to_seeds against creating an env per seed
+
+rebuild creates a single env VecGame restricted to each seed, which is how a specific level had to be
+started before reset_to_seeds. Assets are only loaded by the first VecGame in a process, so rebuild does
+not include that cost. After every reset the level of each env is compared with the level rebuild
+generated for the same seed, so mismatches should always be 0.
+
+usage: reset_to_seeds_benchmark [--envs N] [--threads N] [--seeds N]
+
+*/
+
+#include "../src/basic-abstract-game.h"
+#include "bench-utils.h"
+#include <chrono>
+#include <cstring>
+#include <stdio.h>
+#include <stdlib.h>
+
+static std::shared_ptr<VecGame> make_venv(const std::string &env_name, int num_envs, int num_threads, int start_level, int num_levels) {
+    Options opts;
+    add_env_options(opts, env_name, num_levels, start_level, num_threads);
+    opts.add_bool("use_generated_assets", false);
+    return make_venv(opts, num_envs);
+}
+
+static uint64_t level_hash(BasicAbstractGame *game) {
+    uint64_t hash = 14695981039346656037ULL;
+    auto add = [&hash](uint64_t value) {
+        hash = (hash ^ value) * 1099511628211ULL;
+    };
+
+    add((uint64_t)(game->current_level_seed));
+    for (int i = 0; i < game->grid_size; i++) {
+        add((uint64_t)(game->get_obj(i)));
+    }
+
+    const auto &agent = game->get_agent();
+    float pos[2] = {agent->x, agent->y};
+    uint32_t bits[2];
+    memcpy(bits, pos, sizeof(bits));
+    add(bits[0]);
+    add(bits[1]);
+
+    return hash;
+}
+
+// one buffer per env for each observation space
+struct ObsBuffers {
+    std::vector<std::vector<uint8_t>> storage;
+    std::vector<std::vector<void *>> bufs;
+
+    ObsBuffers(const VecGame &venv) {
+        storage.resize(venv.num_envs * venv.observation_spaces.size());
+        bufs.resize(venv.num_envs);
+        for (int e = 0; e < venv.num_envs; e++) {
+            for (size_t s = 0; s < venv.observation_spaces.size(); s++) {
+                const auto &space = venv.observation_spaces[s];
+                // 4 bytes per element is enough for every dtype
+                size_t size = 4;
+                for (int d = 0; d < space.ndim; d++) {
+                    size *= space.shape[d];
+                }
+                auto &buf = storage[e * venv.observation_spaces.size() + s];
+                buf.resize(size);
+                bufs[e].push_back(buf.data());
+            }
+        }
+    }
+};
+
+int main(int argc, char **argv) {
+    int num_envs = 16;
+    int num_threads = 4;
+    int num_seeds = 256;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--envs") {
+            num_envs = atoi(argv[i + 1]);
+        } else if (arg == "--threads") {
+            num_threads = atoi(argv[i + 1]);
+        } else if (arg == "--seeds") {
+            num_seeds = atoi(argv[i + 1]);
+        }
+    }
+
+    int mismatches = 0;
+
+    printf("%-10s %16s %16s %10s\n", "env", "rebuild_per_sec", "reset_per_sec", "speedup");
+
+    for (std::string env_name : {"bigfish", "coinrun", "heist", "maze", "ninja"}) {
+        // seeds spread over a large range, as an evaluation set would be
+        std::vector<int32_t> seeds(num_seeds);
+        for (int i = 0; i < num_seeds; i++) {
+            seeds[i] = 1000 + i * 7919;
+        }
+
+        std::vector<uint64_t> expected(num_seeds);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < num_seeds; i++) {
+            auto venv = make_venv(env_name, 1, 0, seeds[i], 1);
+            ObsBuffers obs(*venv);
+            venv->reset(obs.bufs);
+            expected[i] = level_hash(dynamic_cast<BasicAbstractGame *>(venv->games[0].get()));
+        }
+        std::chrono::duration<double> rebuild_secs = std::chrono::steady_clock::now() - start;
+
+        auto venv = make_venv(env_name, num_envs, num_threads, 0, 0);
+        ObsBuffers obs(*venv);
+        venv->reset(obs.bufs);
+
+        start = std::chrono::steady_clock::now();
+        for (int first = 0; first < num_seeds; first += num_envs) {
+            std::vector<int32_t> batch(num_envs, -1);
+            for (int e = 0; e < num_envs && first + e < num_seeds; e++) {
+                batch[e] = seeds[first + e];
+            }
+            venv->reset_to_seeds(batch, obs.bufs);
+
+            for (int e = 0; e < num_envs && first + e < num_seeds; e++) {
+                if (level_hash(dynamic_cast<BasicAbstractGame *>(venv->games[e].get())) != expected[first + e]) {
+                    mismatches++;
+                }
+            }
+        }
+        std::chrono::duration<double> reset_secs = std::chrono::steady_clock::now() - start;
+
+        printf("%-10s %16.0f %16.0f %9.1fx\n", env_name.c_str(), num_seeds / rebuild_secs.count(), num_seeds / reset_secs.count(), rebuild_secs.count() / reset_secs.count());
+    }
+
+    printf("mismatches %d\n", mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+/*
+
+Measures level resets per second for caveflyer and jumper, which generate their levels with RoomGenerator
+
+legacy is the previous RoomGenerator update and find_best_room, which counted neighbors cell by cell and
+tracked rooms in std::sets. It is kept here as a reference so that the current RoomGenerator can be checked
+to produce identical grids and rooms on random grids, and timed against it.
+
+usage: roomgen_benchmark [--resets N]
+
+*/
+
+#include "../src/basic-abstract-game.h"
+#include "../src/roomgen.h"
+#include "bench-utils.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+static std::shared_ptr<VecGame> make_venv(const std::string &env_name) {
+    Options opts;
+    add_env_options(opts, env_name, 0, 0, 0);
+    return make_venv(opts, 1);
+}
+
+static void legacy_update(BasicAbstractGame *game) {
+    std::vector<int> next_cells;
+
+    for (int i = 0; i < game->grid_size; i++) {
+        int x, y;
+        game->to_grid_xy(i, &x, &y);
+        next_cells.push_back(game->count_type_in_rect(WALL_OBJ, x - 1, y - 1, x + 1, y + 1) >= 5 ? WALL_OBJ : SPACE);
+    }
+
+    for (int i = 0; i < game->grid_size; i++) {
+        game->set_obj(i, next_cells[i]);
+    }
+}
+
+static void legacy_build_room(BasicAbstractGame *game, int idx, std::set<int> &room) {
+    std::queue<int> curr;
+    curr.push(idx);
+
+    while (curr.size() > 0) {
+        int curr_idx = curr.front();
+        curr.pop();
+
+        int x, y;
+        game->to_grid_xy(curr_idx, &x, &y);
+
+        for (int i = -1; i <= 1; i++) {
+            for (int j = -1; j <= 1; j++) {
+                if ((i == 0 || j == 0) && (i + j != 0)) {
+                    int next_idx = game->to_grid_idx(x + i, y + j);
+
+                    if (!set_contains(room, next_idx) && game->get_obj(next_idx) == SPACE) {
+                        curr.push(next_idx);
+                        room.insert(next_idx);
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void legacy_find_best_room(BasicAbstractGame *game, std::set<int> &best_room) {
+    std::set<int> all_rooms;
+    int best_room_size = -1;
+
+    for (int i = 0; i < game->grid_size; i++) {
+        if (game->get_obj(i) == SPACE && !set_contains(all_rooms, i)) {
+            std::set<int> next_room;
+            legacy_build_room(game, i, next_room);
+            all_rooms.insert(next_room.begin(), next_room.end());
+
+            if (int(next_room.size()) > best_room_size) {
+                best_room_size = (int)(next_room.size());
+                best_room = next_room;
+            }
+        }
+    }
+}
+
+static void fill_random(BasicAbstractGame *game, RandGen &rand_gen) {
+    for (int i = 0; i < game->grid_size; i++) {
+        game->set_obj(i, rand_gen.rand01() < .5 ? WALL_OBJ : SPACE);
+    }
+}
+
+// 4 automaton updates followed by a search for the largest room, as caveflyer does on every reset
+template <typename F>
+double time_rooms(BasicAbstractGame *game, int num_grids, F generate, uint32_t *checksum) {
+    RandGen rand_gen;
+    rand_gen.seed(0);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int g = 0; g < num_grids; g++) {
+        fill_random(game, rand_gen);
+        std::set<int> best_room;
+        generate(best_room);
+        *checksum += (uint32_t)(best_room.size());
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return num_grids / elapsed.count();
+}
+
+int main(int argc, char **argv) {
+    int num_resets = 2000;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::string(argv[i]) == "--resets") {
+            num_resets = atoi(argv[i + 1]);
+        }
+    }
+
+    uint32_t checksum = 0;
+
+    printf("%-10s %-16s %16s\n", "env", "method", "per_sec");
+
+    for (std::string env_name : {"caveflyer", "jumper"}) {
+        auto venv = make_venv(env_name);
+        auto game = dynamic_cast<BasicAbstractGame *>(venv->games[0].get());
+
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < num_resets; r++) {
+            game->reset();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        printf("%-10s %-16s %16.0f\n", env_name.c_str(), "reset", num_resets / elapsed.count());
+
+        RoomGenerator room_gen(game);
+
+        {
+            RandGen rand_gen;
+            for (int seed = 0; seed < 20; seed++) {
+                rand_gen.seed(seed);
+                fill_random(game, rand_gen);
+                std::set<int> expected;
+                for (int it = 0; it < 4; it++) {
+                    legacy_update(game);
+                }
+                legacy_find_best_room(game, expected);
+                std::vector<int> expected_cells;
+                for (int i = 0; i < game->grid_size; i++) {
+                    expected_cells.push_back(game->get_obj(i));
+                }
+
+                rand_gen.seed(seed);
+                fill_random(game, rand_gen);
+                std::set<int> best_room;
+                for (int it = 0; it < 4; it++) {
+                    room_gen.update();
+                }
+                room_gen.find_best_room(best_room);
+
+                fassert(best_room == expected);
+                for (int i = 0; i < game->grid_size; i++) {
+                    fassert(game->get_obj(i) == expected_cells[i]);
+                }
+            }
+        }
+
+        double legacy_rate = time_rooms(game, num_resets, [&](std::set<int> &best_room) {
+            for (int it = 0; it < 4; it++) {
+                legacy_update(game);
+            }
+            legacy_find_best_room(game, best_room);
+        }, &checksum);
+        double rate = time_rooms(game, num_resets, [&](std::set<int> &best_room) {
+            for (int it = 0; it < 4; it++) {
+                room_gen.update();
+            }
+            room_gen.find_best_room(best_room);
+        }, &checksum);
+
+        printf("%-10s %-16s %16.0f\n", env_name.c_str(), "legacy_rooms", legacy_rate);
+        printf("%-10s %-16s %16.0f\n", env_name.c_str(), "rooms", rate);
+    }
+
+    // print the checksum so that the rooms can't be optimized away
+    printf("checksum %u\n", checksum);
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+/*
+
+Measures RandGen's sampling without replacement on grids of 64x64 and 128x128 cells
+
+legacy is the previous erase-based choose_n, which is kept here as a reference so that the
+stream compatible choose_n can be checked to produce identical output for the same seed.
+
+*/
+
+#include "../src/randgen.h"
+#include "../src/cpp-utils.h"
+#include <chrono>
+#include <stdio.h>
+
+const int NUM_SEEDS = 20;
+
+std::vector<int> legacy_choose_n(RandGen &rand_gen, const std::vector<int> &elems, int n) {
+    std::vector<int> chosen;
+    std::vector<int> rem_elems(elems);
+
+    if (n > (int)(elems.size())) {
+        return rem_elems;
+    }
+
+    for (int i = 0; i < n; i++) {
+        int idx = rand_gen.randn((int)(rem_elems.size()));
+        chosen.push_back(rem_elems[idx]);
+        rem_elems.erase(rem_elems.begin() + idx);
+    }
+
+    return chosen;
+}
+
+template <typename F>
+double time_samples(F sample, uint32_t *checksum) {
+    auto start = std::chrono::steady_clock::now();
+
+    for (int seed = 0; seed < NUM_SEEDS; seed++) {
+        std::vector<int> chosen = sample(seed);
+        for (int c : chosen) {
+            *checksum = *checksum * 31 + c;
+        }
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return NUM_SEEDS / elapsed.count();
+}
+
+int main() {
+    uint32_t checksum = 0;
+
+    printf("%-10s %-10s %-20s %16s\n", "grid", "n", "method", "samples_per_sec");
+
+    for (int grid_size : {64, 128}) {
+        std::vector<int> cells(grid_size * grid_size);
+        for (int i = 0; i < (int)(cells.size()); i++) {
+            cells[i] = i;
+        }
+
+        for (int n : {grid_size, (int)(cells.size())}) {
+            RandGen rand_gen;
+
+            for (int seed = 0; seed < NUM_SEEDS; seed++) {
+                rand_gen.seed(seed);
+                std::vector<int> expected = legacy_choose_n(rand_gen, cells, n);
+                rand_gen.seed(seed);
+                fassert(rand_gen.choose_n(cells, n) == expected);
+            }
+
+            double rates[4];
+            rates[0] = time_samples([&](int seed) {
+                rand_gen.seed(seed);
+                return legacy_choose_n(rand_gen, cells, n);
+            }, &checksum);
+            rates[1] = time_samples([&](int seed) {
+                rand_gen.seed(seed);
+                return rand_gen.choose_n(cells, n);
+            }, &checksum);
+            rates[2] = time_samples([&](int seed) {
+                rand_gen.seed(seed);
+                return rand_gen.shuffle_choose_n(cells, n);
+            }, &checksum);
+            rates[3] = time_samples([&](int seed) {
+                rand_gen.seed(seed);
+                return rand_gen.reservoir_choose_n(cells, n);
+            }, &checksum);
+
+            const char *names[] = {"legacy", "choose_n", "shuffle_choose_n", "reservoir_choose_n"};
+            for (int m = 0; m < 4; m++) {
+                printf("%-10d %-10d %-20s %16.1f\n", grid_size, n, names[m], rates[m]);
+            }
+        }
+    }
+
+    // print the checksum so that the samples can't be optimized away
+    printf("checksum %u\n", checksum);
+
+    return 0;
+}
@@ -43,9 +43,11 @@ def check(proc, verbose):
         print(f"RUN {proc.args}:\n{proc.stdout}")
 
 
-def build(package=False, debug=False):
+def build(package=False, debug=False, headless=False):
     """
     Build the requested environment in a process-safe manner and only once per process.
+
+    If headless is set, only libenv_core is built, which does not render and does not require Qt.
     """
     build_dir = os.path.join(SCRIPT_DIR, ".build")
     os.makedirs(build_dir, exist_ok=True)
@@ -54,6 +56,11 @@ def build(package=False, debug=False):
     if debug:
         build_type = "debug"
 
+    # the headless library is configured in its own folder so that both can be built side by side
+    build_name = build_type
+    if headless:
+        build_name += "-headless"
+
     if "MAKEFLAGS" not in os.environ:
         os.environ["MAKEFLAGS"] = f"-j{mp.cpu_count()}"
 
@@ -78,7 +85,7 @@ def build(package=False, debug=False):
 
     with chdir(build_dir), global_build_lock:
         # check if we have built yet in this process
-        if build_type not in global_builds:
+        if build_name not in global_builds:
             if package:
                 # avoid the filelock dependency when building from setup.py
                 lock_ctx = nullcontext()
@@ -87,8 +94,8 @@ def build(package=False, debug=False):
                 import filelock
                 lock_ctx = filelock.FileLock(".build-lock")
             with lock_ctx:
-                os.makedirs(build_type, exist_ok=True)
-                with chdir(build_type):
+                os.makedirs(build_name, exist_ok=True)
+                with chdir(build_name):
                     sys.stdout.write("building procgen...")
                     sys.stdout.flush()
                     generator = "Unix Makefiles"
@@ -102,6 +109,8 @@ def build(package=False, debug=False):
                     ]
                     if package:
                         configure_cmd.append("-DPROCGEN_PACKAGE=ON")
+                    if headless:
+                        configure_cmd += ["-DPROCGEN_RENDERING=OFF", "-DPROCGEN_CORE=ON"]
                     if platform.system() != "Windows":
                         # this is not used on windows, the option needs to be passed to cmake --build instead
                         configure_cmd.append(f"-DCMAKE_BUILD_TYPE={build_type}")
@@ -119,9 +128,9 @@ def build(package=False, debug=False):
                     check(run(build_cmd), verbose=package)
                     print("done")
 
-            global_builds.add(build_type)
+            global_builds.add(build_name)
 
-    lib_dir = os.path.join(build_dir, build_type)
+    lib_dir = os.path.join(build_dir, build_name)
     if platform.system() == "Windows":
         # the built library is in a different location on windows
         lib_dir = os.path.join(lib_dir, build_type)
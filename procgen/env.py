@@ -48,6 +48,16 @@ DISTRIBUTION_MODE_DICT = {
     "exploration": 20,
 }
 
+# should match LevelStat in level-stats.h, the order of the values in the level_stats info array
+LEVEL_STAT_NAMES = [
+    "path_length",
+    "keys",
+    "doors",
+    "coins",
+    "dead_ends",
+    "open_cells",
+]
+
 
 def create_random_seed():
     rand_seed = random.SystemRandom().randint(0, 2 ** 31 - 1)
@@ -76,24 +86,37 @@ class BaseProcgenEnv(CVecEnv):
         num_levels=0,
         start_level=0,
         use_sequential_levels=False,
+        use_fast_level_generation=False,
+        use_continuous_collision=False,
         debug_mode=0,
         resource_root=None,
         num_threads=4,
         additional_info_spaces = None,
         additional_obs_spaces = None,
         max_episodes_per_game = None,
+        rand_gen_backend="mt19937",
+        level_cache_mb=0,
+        level_pack=None,
+        level_stats=False,
+        level_sampler=False,
+        level_sampler_temperature=1.0,
+        level_sampler_staleness=0.0,
+        level_sweep=False,
+        headless=False,
     ):
         if resource_root is None:
             resource_root = os.path.join(SCRIPT_DIR, "data", "assets") + os.sep
             assert os.path.exists(resource_root)
 
+        # the headless library is never part of the package, it is always built from source
+        lib_name = "env_core" if headless else "env"
         lib_dir = os.path.join(SCRIPT_DIR, "data", "prebuilt")
-        if os.path.exists(lib_dir):
+        if os.path.exists(lib_dir) and not headless:
             assert any([os.path.exists(os.path.join(lib_dir, name)) for name in ["libenv.so", "libenv.dylib", "env.dll"]]), "package is installed, but the prebuilt environment library is missing"
             assert not debug, "debug has no effect for pre-compiled library"
         else:
             # only compile if we don't find a pre-built binary
-            lib_dir = build(debug=debug)
+            lib_dir = build(debug=debug, headless=headless)
 
         self.combos = self.get_combos()
 
@@ -109,6 +132,23 @@ class BaseProcgenEnv(CVecEnv):
 
         assert max_episodes_per_game.size == num_envs
 
+        if level_pack is not None:
+            options["level_pack"] = os.fspath(level_pack)
+
+        if level_sampler:
+            assert num_levels > 0, "the level sampler requires num_levels > 0"
+            assert level_sampler_temperature > 0, "level_sampler_temperature must be positive"
+            assert 0 <= level_sampler_staleness <= 1, "level_sampler_staleness must be in [0, 1]"
+
+        if level_sweep:
+            assert num_levels > 0, "the level sweep requires num_levels > 0"
+            assert not level_sampler, "the level sweep cannot be combined with the level sampler"
+            assert not use_sequential_levels, "the level sweep cannot be combined with use_sequential_levels"
+
+        if level_stats:
+            additional_info_spaces = list(additional_info_spaces or [])
+            additional_info_spaces.append(CVecEnv.C_Space("level_stats", False, (len(LEVEL_STAT_NAMES),), int, (-1, 2 ** 31 - 1)))
+
         options.update(
             {
                 "env_name": env_name,
@@ -116,19 +156,27 @@ class BaseProcgenEnv(CVecEnv):
                 "start_level": start_level,
                 "num_actions": len(self.combos),
                 "use_sequential_levels": bool(use_sequential_levels),
+                "use_fast_level_generation": bool(use_fast_level_generation),
+                "use_continuous_collision": bool(use_continuous_collision),
                 "debug_mode": debug_mode,
                 "rand_seed": rand_seed,
                 "num_threads": num_threads,
                 # these will only be used the first time an environment is created in a process
                 "resource_root": resource_root,
                 "max_episodes_per_game": max_episodes_per_game,
+                "rand_gen_backend": rand_gen_backend,
+                "level_cache_mb": int(level_cache_mb),
+                "use_level_sampler": bool(level_sampler),
+                "level_sampler_temperature": float(level_sampler_temperature),
+                "level_sampler_staleness": float(level_sampler_staleness),
+                "use_level_sweep": bool(level_sweep),
             }
         )
 
         self.options = options
 
         super().__init__(
-            lib_dir=lib_dir, num_envs=num_envs, debug=debug, options=options, additional_info_spaces=additional_info_spaces, additional_obs_spaces=additional_obs_spaces
+            lib_dir=lib_dir, lib_name=lib_name, num_envs=num_envs, debug=debug, options=options, additional_info_spaces=additional_info_spaces, additional_obs_spaces=additional_obs_spaces
         )
 
     def get_combos(self):
@@ -1,6 +1,6 @@
 import numpy as np
 import pytest
-from .env import ENV_NAMES
+from .env import ENV_NAMES, LEVEL_STAT_NAMES
 from procgen import ProcgenEnv
 
 
@@ -54,6 +54,261 @@ def test_determinism(env_name):
     assert np.array_equal(obs1, obs2)
 
 
+def collect_random_observations(env_name, **kwargs):
+    rng = np.random.RandomState(0)
+    venv = ProcgenEnv(num_envs=2, env_name=env_name, rand_seed=23, **kwargs)
+    obs = venv.reset()
+    obses = [obs["rgb"]]
+    for _ in range(128):
+        obs, _rew, _done, _info = venv.step(
+            rng.randint(
+                low=0, high=venv.action_space.n, size=(venv.num_envs,), dtype=np.int32
+            )
+        )
+        obses.append(obs["rgb"])
+    venv.close()
+    return np.array(obses)
+
+
+@pytest.mark.parametrize("env_name", ["coinrun", "starpilot", "miner"])
+def test_pcg32_determinism(env_name):
+    obs1 = collect_random_observations(env_name, rand_gen_backend="pcg32")
+    obs2 = collect_random_observations(env_name, rand_gen_backend="pcg32")
+    assert np.array_equal(obs1, obs2)
+
+
+@pytest.mark.parametrize("env_name", ["coinrun", "starpilot", "miner"])
+@pytest.mark.parametrize("rand_gen_backend", ["mt19937", "pcg32"])
+def test_fast_level_generation_determinism(env_name, rand_gen_backend):
+    obs1 = collect_random_observations(
+        env_name, rand_gen_backend=rand_gen_backend, use_fast_level_generation=True
+    )
+    obs2 = collect_random_observations(
+        env_name, rand_gen_backend=rand_gen_backend, use_fast_level_generation=True
+    )
+    assert np.array_equal(obs1, obs2)
+
+
+@pytest.mark.parametrize("env_name", ["coinrun", "starpilot", "miner"])
+def test_continuous_collision_determinism(env_name):
+    obs1 = collect_random_observations(env_name, use_continuous_collision=True)
+    obs2 = collect_random_observations(env_name, use_continuous_collision=True)
+    assert np.array_equal(obs1, obs2)
+
+
+@pytest.mark.parametrize("env_name", ["coinrun", "miner"])
+def test_headless(env_name):
+    def collect_steps(headless):
+        rng = np.random.RandomState(0)
+        venv = ProcgenEnv(num_envs=2, env_name=env_name, rand_seed=23, headless=headless)
+        obs = venv.reset()
+        steps = []
+        for _ in range(128):
+            obs, rew, done, info = venv.step(
+                rng.randint(
+                    low=0,
+                    high=venv.action_space.n,
+                    size=(venv.num_envs,),
+                    dtype=np.int32,
+                )
+            )
+            steps.append((obs["rgb"], rew, done, [i["level_seed"] for i in info]))
+        return steps
+
+    for rendered, headless in zip(collect_steps(False), collect_steps(True)):
+        assert not np.any(headless[0])
+        for a, b in zip(rendered[1:], headless[1:]):
+            assert np.array_equal(a, b)
+
+
+@pytest.mark.parametrize("env_name", ["caveflyer", "chaser", "heist", "jumper", "maze"])
+def test_level_stats(env_name):
+    venv = ProcgenEnv(num_envs=2, env_name=env_name, rand_seed=23, level_stats=True)
+    venv.reset()
+    for _ in range(16):
+        _, _, _, infos = venv.step(np.zeros(venv.num_envs, dtype=np.int32))
+        for info in infos:
+            stats = dict(zip(LEVEL_STAT_NAMES, info["level_stats"]))
+            assert stats["open_cells"] > 0
+            assert stats["keys"] == stats["doors"]
+            if env_name != "chaser":
+                assert 0 <= stats["path_length"] < stats["open_cells"]
+
+
+@pytest.mark.parametrize("env_name", ["caveflyer", "heist", "maze"])
+def test_level_cache(env_name):
+    def collect_steps(level_cache_mb):
+        rng = np.random.RandomState(0)
+        venv = ProcgenEnv(num_envs=4, env_name=env_name, rand_seed=23, num_levels=3, level_cache_mb=level_cache_mb)
+        obs = venv.reset()
+        steps = [obs["rgb"]]
+        for _ in range(512):
+            obs, rew, done, info = venv.step(
+                rng.randint(
+                    low=0,
+                    high=venv.action_space.n,
+                    size=(venv.num_envs,),
+                    dtype=np.int32,
+                )
+            )
+            steps.append((obs["rgb"], rew, done, [i["level_seed"] for i in info]))
+        return steps
+
+    for uncached, cached in zip(collect_steps(0), collect_steps(16)):
+        for a, b in zip(uncached, cached):
+            assert np.array_equal(a, b)
+
+
+@pytest.mark.parametrize("env_name", ["coinrun", "maze"])
+def test_reset_to_seeds(env_name):
+    venv = ProcgenEnv(num_envs=3, env_name=env_name, rand_seed=23, num_threads=2)
+    venv.reset()
+    for _ in range(8):
+        venv.step(np.zeros(venv.num_envs, dtype=np.int32))
+
+    venv.reset_to_seeds(np.array([5, -1, 5], dtype=np.int32))
+    _, _, _, infos = venv.step(np.zeros(venv.num_envs, dtype=np.int32))
+    assert infos[0]["level_seed"] == 5 and infos[2]["level_seed"] == 5
+    assert infos[1]["level_seed"] != 5
+
+    # the same seed and actions must play out the same in both envs
+    for _ in range(32):
+        obs, rew, done, infos = venv.step(np.zeros(venv.num_envs, dtype=np.int32))
+        assert np.array_equal(obs["rgb"][0], obs["rgb"][2])
+        assert rew[0] == rew[2] and done[0] == done[2]
+
+
+def test_level_sweep():
+    num_levels = 10
+    venv = ProcgenEnv(num_envs=4, env_name="coinrun", rand_seed=23, start_level=100, num_levels=num_levels, level_sweep=True)
+    venv.reset()
+    rng = np.random.RandomState(0)
+    seen = set()
+    while not np.all(venv.all_episodes_done()):
+        _, _, _, infos = venv.step(rng.randint(low=0, high=venv.action_space.n, size=(venv.num_envs,), dtype=np.int32))
+        seen.update(int(info["level_seed"]) for info in infos)
+
+    assert seen == set(range(100, 100 + num_levels))
+    results = venv.get_level_sweep_results()
+    assert np.all(results["lengths"] > 0)
+    assert results["returns"].shape == (num_levels,)
+
+
+def test_level_sweep_reset_to_seeds():
+    # levels abandoned by reset_to_seeds are played again, so the sweep still records every level
+    num_levels = 10
+    venv = ProcgenEnv(num_envs=4, env_name="coinrun", rand_seed=23, start_level=100, num_levels=num_levels, level_sweep=True)
+    venv.reset()
+    rng = np.random.RandomState(0)
+    for t in range(100000):
+        if np.all(venv.all_episodes_done()):
+            break
+        if t % 50 == 0 and t < 2000:
+            level_seeds = np.full(venv.num_envs, -1, dtype=np.int32)
+            level_seeds[t % venv.num_envs] = 5
+            venv.reset_to_seeds(level_seeds)
+        venv.step(rng.randint(low=0, high=venv.action_space.n, size=(venv.num_envs,), dtype=np.int32))
+
+    assert np.all(venv.all_episodes_done())
+    results = venv.get_level_sweep_results()
+    assert np.all(results["lengths"] > 0)
+
+
+def test_grid_batch_step():
+    def make_venv():
+        venv = ProcgenEnv(num_envs=4, env_name="maze", rand_seed=23, num_levels=5)
+        venv.reset()
+        return venv
+
+    stepped = make_venv()
+    batched = make_venv()
+    rng = np.random.RandomState(0)
+    for t in range(1000):
+        actions = rng.randint(low=0, high=stepped.action_space.n, size=(stepped.num_envs,), dtype=np.int32)
+        if t % 97 == 0:
+            actions[t % stepped.num_envs] = -1
+        _, rew, done, infos = stepped.step(actions)
+        batch_rew, batch_done, batch_level_complete = batched.grid_batch_step(actions)
+        assert np.array_equal(rew, batch_rew)
+        assert np.array_equal(done, batch_done)
+        assert batch_level_complete.tolist() == [bool(info["level_complete"]) for info in infos]
+
+    # normal steps continue from the state the batched steps left
+    for _ in range(16):
+        actions = rng.randint(low=0, high=stepped.action_space.n, size=(stepped.num_envs,), dtype=np.int32)
+        obs, rew, done, infos = stepped.step(actions)
+        batch_obs, batch_rew, batch_done, batch_infos = batched.step(actions)
+        assert np.array_equal(obs["rgb"], batch_obs["rgb"])
+        assert np.array_equal(rew, batch_rew) and np.array_equal(done, batch_done)
+        assert [i["level_seed"] for i in infos] == [i["level_seed"] for i in batch_infos]
+
+
+def test_level_sampler():
+    venv = ProcgenEnv(num_envs=4, env_name="coinrun", rand_seed=23, start_level=10, num_levels=8, level_sampler=True)
+    venv.update_level_scores(np.arange(10, 18), np.eye(8)[5])
+    venv.reset()
+    rng = np.random.RandomState(0)
+    # levels drawn before the update are played until their episode ends
+    started = np.zeros(venv.num_envs, dtype=bool)
+    for _ in range(1000):
+        _, _, done, infos = venv.step(rng.randint(low=0, high=venv.action_space.n, size=(venv.num_envs,), dtype=np.int32))
+        for i, info in enumerate(infos):
+            if started[i]:
+                assert info["level_seed"] == 15
+        started |= done
+    assert np.all(started)
+
+
+def test_level_sampler_threads():
+    # the staleness of levels is shared by all envs, draws must not depend on the order the threads ran in
+    venvs = [
+        ProcgenEnv(num_envs=16, env_name="coinrun", rand_seed=5, num_levels=50, level_sampler=True, level_sampler_staleness=0.5, num_threads=num_threads)
+        for num_threads in [4, 4, 0]
+    ]
+    for venv in venvs:
+        venv.reset()
+    rng = np.random.RandomState(0)
+    for t in range(1000):
+        if t % 100 == 0:
+            scores = rng.rand(50)
+            for venv in venvs:
+                venv.update_level_scores(np.arange(50), scores)
+        actions = rng.randint(low=0, high=venvs[0].action_space.n, size=(16,), dtype=np.int32)
+        level_seeds = []
+        for venv in venvs:
+            _, _, _, infos = venv.step(actions)
+            level_seeds.append([info["level_seed"] for info in infos])
+        assert level_seeds[0] == level_seeds[1] == level_seeds[2]
+    for venv in venvs:
+        venv.close()
+
+
+def test_level_sampler_update_during_step():
+    # scores pushed while a step is in progress apply from the next step, as if pushed after step_wait
+    venvs = [
+        ProcgenEnv(num_envs=16, env_name="bigfish", rand_seed=5, num_levels=50, level_sampler=True, level_sampler_staleness=0.5)
+        for _ in range(2)
+    ]
+    for venv in venvs:
+        venv.reset()
+    rng = np.random.RandomState(0)
+    for t in range(1000):
+        actions = rng.randint(low=0, high=venvs[0].action_space.n, size=(16,), dtype=np.int32)
+        scores = rng.rand(50)
+        level_seeds = []
+        for i, venv in enumerate(venvs):
+            venv.step_async(actions)
+            if i == 0:
+                venv.update_level_scores(np.arange(50), scores)
+            _, _, _, infos = venv.step_wait()
+            if i == 1:
+                venv.update_level_scores(np.arange(50), scores)
+            level_seeds.append([info["level_seed"] for info in infos])
+        assert level_seeds[0] == level_seeds[1]
+    for venv in venvs:
+        venv.close()
+
+
 @pytest.mark.parametrize("env_name", ENV_NAMES)
 @pytest.mark.parametrize("num_envs", [1, 2, 16])
 def test_multi_speed(env_name, num_envs, benchmark):
@@ -135,6 +135,29 @@ struct libenv_step {
     void **infos;
 };
 
+// libenv_memory_stat holds the memory used by one category of data
+//
+// per_env_bytes is the average number of bytes owned by each environment
+// shared_bytes is the number of bytes shared by all environments in the process that use it
+struct libenv_memory_stat {
+    char name[LIBENV_MAX_NAME_LEN];
+    int64_t per_env_bytes;
+    int64_t shared_bytes;
+};
+
+// libenv_level_cache_stats holds the counters of the level cache shared by all environments in the process
+//
+// hits and misses count lookups by environments with level_cache_mb set
+// bytes and capacity_bytes are the memory used by cached levels and the most it may use
+struct libenv_level_cache_stats {
+    int64_t hits;
+    int64_t misses;
+    int64_t evictions;
+    int64_t levels;
+    int64_t bytes;
+    int64_t capacity_bytes;
+};
+
 #if !defined(NO_PROTOTYPE)
 
 // libenv_make creates a new environment instance
@@ -160,6 +183,14 @@ LIBENV_API int libenv_get_spaces(libenv_venv *handle, enum libenv_spaces_name na
 // the step object belongs to the caller, along with the obs buffer which must be allocated by the caller
 LIBENV_API void libenv_reset(libenv_venv *handle, struct libenv_step *step);
 
+// libenv_reset_to_seeds starts a new episode on level_seeds[i] in each env i where it is not -1 and writes
+// the first observation of those envs to the obs buffer, other envs and their buffers are left unchanged
+// the level_seeds array must have one entry per env, envs are reset in parallel and the call returns when all are done
+// it must not be called between libenv_step_async and libenv_step_wait
+// with use_level_sweep, a level whose episode is cut short is played again by a later reset, and the forced
+// episode is not recorded in the sweep results
+LIBENV_API void libenv_reset_to_seeds(libenv_venv *handle, const int32_t *level_seeds, struct libenv_step *step);
+
 // libenv_step_async submits an action to the environment, but doesn't wait for it to complete
 //
 // the environment may apply the action in a thread, or else just store it and apply it when
@@ -177,6 +208,13 @@ LIBENV_API void libenv_step_async(libenv_venv *handle, const void **acts, struct
 // episode
 LIBENV_API void libenv_step_wait(libenv_venv *handle);
 
+// libenv_grid_batch_step takes one step in every env on the calling thread, without rendering observations or
+// filling in infos, for games that support GridBatch such as maze
+// acts, rews, dones and level_completes have one entry per env, an action of -1 ends the episode as in libenv_step_async
+// the next libenv_step_async, libenv_reset_to_seeds or libenv_render continues from the state these steps left
+// it must not be called before the environment is reset or between libenv_step_async and libenv_step_wait
+LIBENV_API void libenv_grid_batch_step(libenv_venv *handle, const int32_t *acts, float *rews, uint8_t *dones, uint8_t *level_completes);
+
 // libenv_render renders the environment
 //
 // the mode must be defined in render_spaces.  the value of frames will be an array of buffer pointers
@@ -194,6 +232,27 @@ LIBENV_API int libenv_add_space(libenv_venv *handle, enum libenv_spaces_name nam
 
 LIBENV_API int libenv_all_episodes_done(libenv_venv *handle, bool *all_episodes_done);
 
+// libenv_get_memory_stats reports the memory used by the environment, one entry per category
+// the caller must allocate the stats array with room for capacity entries and owns the memory
+// at most capacity entries are written, the return value is the number of categories, so if it is larger
+// than capacity the caller should retry with a larger array
+LIBENV_API int libenv_get_memory_stats(libenv_venv *handle, struct libenv_memory_stat *stats, int capacity);
+
+// libenv_get_level_cache_stats reports the counters of the process-wide level cache
+LIBENV_API void libenv_get_level_cache_stats(libenv_venv *handle, struct libenv_level_cache_stats *stats);
+
+// libenv_get_level_sweep_results copies the result of every level of the sweep, indexed by level seed - start_level
+// the environment must have been created with use_level_sweep, and the caller must allocate arrays of num_levels entries
+// lengths are -1 for levels whose episode has not ended yet
+// if called between libenv_step_async and libenv_step_wait, it waits for the step and includes its results
+// if called with null pointers, returns the number of levels that are required
+LIBENV_API int libenv_get_level_sweep_results(libenv_venv *handle, float *returns, int32_t *lengths, uint8_t *level_complete);
+
+// libenv_update_level_scores sets the scores that the level sampler draws levels in proportion to
+// the environment must have been created with use_level_sampler, seeds outside its levels are ignored
+// if called between libenv_step_async and libenv_step_wait, it waits for the step, whose resets keep the old scores
+LIBENV_API void libenv_update_level_scores(libenv_venv *handle, const int32_t *level_seeds, const float *scores, int count);
+
 
 #endif
 
@@ -437,6 +437,27 @@ class CVecEnv:
         self._c_lib.libenv_reset(self._c_env, self._c_step)
         return self._maybe_copy_dict(self._observations)
 
+    def reset_to_seeds(self, level_seeds: np.ndarray) -> Dict[str, np.ndarray]:
+        """
+        Start a new episode on level_seeds[i] in each env i where it is not -1, and return the observations
+
+        Envs with a seed of -1 continue their episode and keep their last observation. This does not
+        count as a step, so no rewards, dones or infos are produced. With the level sweep, a sweep level
+        whose episode is cut short is played again later, and the forced episodes are not recorded.
+        """
+        assert self._state != STATE_WAIT_WAIT, "reset_to_seeds cannot be called while a step is in progress"
+        level_seeds = np.ascontiguousarray(level_seeds, dtype=np.int32).reshape(-1)
+        assert level_seeds.shape == (self.num_envs,), "level_seeds must have one entry per env"
+        assert np.all(level_seeds >= -1), "level seeds must be non-negative, or -1 to leave an env unchanged"
+        if self._state == STATE_NEEDS_RESET:
+            assert np.all(level_seeds >= 0), "every env needs a seed until the environment has been reset"
+        self._state = STATE_WAIT_ACT
+
+        self._c_lib.libenv_reset_to_seeds(
+            self._c_env, self._ffi.cast("int32_t *", level_seeds.ctypes.data), self._c_step
+        )
+        return self._maybe_copy_dict(self._observations)
+
     def step_async(self, actions: np.ndarray) -> None:
         """
         Asynchronously take an action in the environment, doesn't return anything.
@@ -491,6 +512,29 @@ class CVecEnv:
         self.step_async(actions)
         return self.step_wait()
 
+    def grid_batch_step(self, actions: np.ndarray) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+        """
+        Step every env once without rendering, returns (rews, dones, level_completes)
+
+        Only games whose step just moves the agent on its grid support this (maze), the agents of all envs
+        are moved together in one loop. No observations or infos are produced, the next step() continues
+        from where these steps left off and renders as usual. An action of -1 ends the episode as in step().
+        """
+        assert self._state == STATE_WAIT_ACT, "grid_batch_step needs a reset environment and no step in progress"
+        actions = np.ascontiguousarray(actions, dtype=np.int32).reshape(-1)
+        assert actions.shape == (self.num_envs,), "actions must have one entry per env"
+        rews = np.zeros(self.num_envs, dtype=np.float32)
+        dones = np.zeros(self.num_envs, dtype=np.uint8)
+        level_completes = np.zeros(self.num_envs, dtype=np.uint8)
+        self._c_lib.libenv_grid_batch_step(
+            self._c_env,
+            self._ffi.cast("int32_t *", actions.ctypes.data),
+            self._ffi.cast("float *", rews.ctypes.data),
+            self._ffi.cast("uint8_t *", dones.ctypes.data),
+            self._ffi.cast("uint8_t *", level_completes.ctypes.data),
+        )
+        return rews, dones.astype(bool), level_completes.astype(bool)
+
     def render(self, mode: str = "human") -> Union[bool, np.ndarray]:
         """
         Render the environment.
@@ -618,6 +662,93 @@ class CVecEnv:
         self._c_lib.libenv_all_episodes_done(self._c_env, cffi_arr)
         return all_done
 
+    def get_memory_stats(self) -> Dict[str, Dict[str, int]]:
+        """
+        Get the memory used by the environment by category
+
+        Returns a dict mapping each category to the average bytes owned by each env ("per_env")
+        and the bytes shared by all envs in the process ("shared")
+        """
+        capacity = 0
+        c_stats = self._ffi.NULL
+        count = self._c_lib.libenv_get_memory_stats(self._c_env, c_stats, capacity)
+        # the number of categories can change between calls, for instance when the level cache grows
+        while count > capacity:
+            capacity = count
+            c_stats = self._ffi.new("struct libenv_memory_stat[%d]" % capacity)
+            count = self._c_lib.libenv_get_memory_stats(self._c_env, c_stats, capacity)
+
+        stats = {}
+        for i in range(count):
+            name = self._ffi.string(c_stats[i].name).decode("utf8")
+            stats[name] = {
+                "per_env": c_stats[i].per_env_bytes,
+                "shared": c_stats[i].shared_bytes,
+            }
+        return stats
+
+    def get_level_cache_stats(self) -> Dict[str, float]:
+        """
+        Get the counters of the level cache shared by every env in the process
+
+        The cache is only used by envs created with level_cache_mb > 0
+        """
+        c_stats = self._ffi.new("struct libenv_level_cache_stats *")
+        self._c_lib.libenv_get_level_cache_stats(self._c_env, c_stats)
+
+        lookups = c_stats.hits + c_stats.misses
+        return {
+            "hits": c_stats.hits,
+            "misses": c_stats.misses,
+            "hit_rate": c_stats.hits / lookups if lookups > 0 else 0.0,
+            "evictions": c_stats.evictions,
+            "levels": c_stats.levels,
+            "bytes": c_stats.bytes,
+            "capacity_bytes": c_stats.capacity_bytes,
+        }
+
+    def get_level_sweep_results(self) -> Dict[str, np.ndarray]:
+        """
+        Get the result of every level of the level sweep, indexed by level seed - start_level
+
+        The env must have been created with the level sweep enabled. Lengths are -1 for levels whose
+        episode has not ended yet, the sweep is over once all_episodes_done() is true for every env.
+        """
+        num_levels = self._c_lib.libenv_get_level_sweep_results(self._c_env, self._ffi.NULL, self._ffi.NULL, self._ffi.NULL)
+        returns = np.zeros(num_levels, dtype=np.float32)
+        lengths = np.zeros(num_levels, dtype=np.int32)
+        level_complete = np.zeros(num_levels, dtype=np.uint8)
+        self._c_lib.libenv_get_level_sweep_results(
+            self._c_env,
+            self._ffi.cast("float *", returns.ctypes.data),
+            self._ffi.cast("int32_t *", lengths.ctypes.data),
+            self._ffi.cast("uint8_t *", level_complete.ctypes.data),
+        )
+        return {
+            "returns": returns,
+            "lengths": lengths,
+            "level_complete": level_complete.astype(bool),
+        }
+
+    def update_level_scores(self, level_seeds: np.ndarray, scores: np.ndarray) -> None:
+        """
+        Set the scores of levels for the level sampler, which draws levels in proportion to them
+
+        The env must have been created with the level sampler enabled. Scores must be non-negative,
+        seeds outside the env's levels are ignored. Called during a step, it waits for the step to
+        finish, and the new scores apply from the next step.
+        """
+        level_seeds = np.ascontiguousarray(level_seeds, dtype=np.int32).reshape(-1)
+        scores = np.ascontiguousarray(scores, dtype=np.float32).reshape(-1)
+        assert level_seeds.shape == scores.shape, "level_seeds and scores must have the same length"
+        assert np.all(scores >= 0) and np.all(np.isfinite(scores)), "scores must be finite and non-negative"
+        self._c_lib.libenv_update_level_scores(
+            self._c_env,
+            self._ffi.cast("int32_t *", level_seeds.ctypes.data),
+            self._ffi.cast("float *", scores.ctypes.data),
+            len(scores),
+        )
+
 
     def get_images(self) -> np.ndarray:
         """
@@ -7,10 +7,14 @@ Generate assets procedurally
 */
 
 #include "randgen.h"
+#ifdef PROCGEN_HEADLESS
+#include "qt-headless.h"
+#else
 #include <QColor>
 #include <QImage>
 #include <QRectF>
 #include <QtGui/QPainter>
+#endif
 #include <memory>
 
 struct ColorGen;
@@ -1,7 +1,11 @@
 #include "basic-abstract-game.h"
+#include "collision-kernels.h"
+#include "level-pack.h"
+#include "levelgen-profile.h"
 #include "resources.h"
 #include "assetgen.h"
 #include "qt-utils.h"
+#include <algorithm>
 
 const float MAXVTHETA = 15 * PI / 180;
 const float MIXRATEROT = 0.5f;
@@ -9,6 +13,9 @@ const float MIXRATEROT = 0.5f;
 // A small constant buffer for handling collision detction and object pushing
 const float POS_EPS = -0.001f;
 
+// collision queries skip the entity store and the broadphase up to this many entities, see uses_direct_scan
+const int DIRECT_SCAN_MAX_ENTITIES = 64;
+
 // When the grid isn't integer aligned, consecutive blocks render with small gaps between them
 // This hack closes the gaps
 const float RENDER_EPS = 0.02f;
@@ -65,19 +72,92 @@ void BasicAbstractGame::game_init() {
         use_procgen_background = false;
     }
 
-    basic_assets.clear();
-    basic_reflections.clear();
-    asset_aspect_ratios.clear();
-    asset_num_themes.clear();
+    shared_assets = get_shared_game_data<SharedAssets>(game_name + "/" + std::to_string(options.use_generated_assets) + "/" + std::to_string(fixed_asset_seed));
+}
+
+SharedAssets::SharedAssets() {
+    initialized = std::make_unique<std::atomic<bool>[]>(USE_ASSET_THRESHOLD * MAX_IMAGE_THEMES);
+    num_themes = std::make_unique<std::atomic<int>[]>(USE_ASSET_THRESHOLD);
+
+    assets.resize(USE_ASSET_THRESHOLD * MAX_IMAGE_THEMES, nullptr);
+    reflections.resize(USE_ASSET_THRESHOLD * MAX_IMAGE_THEMES, nullptr);
+    aspect_ratios.resize(USE_ASSET_THRESHOLD * MAX_IMAGE_THEMES, 0);
+
+    for (int i = 0; i < USE_ASSET_THRESHOLD * MAX_IMAGE_THEMES; i++) {
+        initialized[i] = false;
+    }
 
-    basic_assets.resize(USE_ASSET_THRESHOLD * MAX_IMAGE_THEMES, nullptr);
-    basic_reflections.resize(USE_ASSET_THRESHOLD * MAX_IMAGE_THEMES, nullptr);
-    asset_aspect_ratios.resize(USE_ASSET_THRESHOLD * MAX_IMAGE_THEMES, 0);
-    asset_num_themes.resize(USE_ASSET_THRESHOLD, 0);
+    for (int i = 0; i < USE_ASSET_THRESHOLD; i++) {
+        num_themes[i] = 0;
+    }
+}
+
+size_t SharedAssets::memory_bytes() {
+    std::lock_guard<std::mutex> lock(init_mutex);
+
+    size_t bytes = sizeof(SharedAssets);
+    bytes += assets.size() * (sizeof(std::atomic<bool>) + 2 * sizeof(std::shared_ptr<QImage>) + sizeof(float));
+    bytes += USE_ASSET_THRESHOLD * sizeof(std::atomic<int>);
+
+    for (const auto &images : {&assets, &reflections}) {
+        for (const auto &image : *images) {
+            if (image != nullptr) {
+                bytes += sizeof(QImage) + image->sizeInBytes();
+            }
+        }
+    }
+
+    return bytes;
+}
+
+void BasicAbstractGame::memory_usage(MemoryUsage &usage) {
+    Game::memory_usage(usage);
+
+    usage.add_env("grid", grid.memory_bytes() + empty_grid.memory_bytes());
+
+    // shared_ptr allocations made with new keep their control block in a separate allocation
+    size_t entity_bytes = entities.capacity() * sizeof(std::shared_ptr<Entity>);
+    entity_bytes += entities.size() * (sizeof(Entity) + 2 * sizeof(void *) + 2 * sizeof(long));
+    usage.add_env("entities", entity_bytes);
+    usage.add_env("entity_pool", entity_pool->memory_bytes());
+    usage.add_env("entity_store", entity_store.memory_bytes());
+    usage.add_env("spatial_hash", spatial_hash.memory_bytes());
+    usage.add_env("collision_table", collision_table.memory_bytes());
+    usage.add_env("placement_map", placement_map.memory_bytes());
+    usage.add_env("contact_tracker", contact_tracker.memory_bytes() + ended_contacts.capacity() * sizeof(ContactPair));
+
+    if (options.level_cache_mb > 0) {
+        usage.add_shared("level_cache", &LevelCache::shared(), (size_t)(LevelCache::shared().stats().bytes));
+    }
+    if (level_pack != nullptr) {
+        usage.add_shared("level_pack", level_pack.get(), level_pack->size_bytes());
+    }
+
+    size_t bg_bytes = 0;
+    for (const auto &image : *main_bg_images_ptr) {
+        bg_bytes += sizeof(QImage) + image->sizeInBytes();
+    }
+
+    // procedurally generated backgrounds are redrawn on every reset, so each env owns its own
+    if (use_procgen_background) {
+        usage.add_env("background", bg_bytes);
+    } else {
+        usage.add_shared("backgrounds", main_bg_images_ptr, bg_bytes);
+    }
+
+    usage.add_shared("assets", shared_assets.get(), shared_assets->memory_bytes());
 }
 
 void BasicAbstractGame::initialize_asset_if_necessary(int img_idx) {
-    if (basic_assets.at(img_idx) != nullptr)
+    fassert(0 <= img_idx && img_idx < USE_ASSET_THRESHOLD * MAX_IMAGE_THEMES);
+
+    if (shared_assets->initialized[img_idx].load(std::memory_order_acquire))
+        return;
+
+    std::lock_guard<std::mutex> lock(shared_assets->init_mutex);
+
+    // another env may have initialized the asset while we were waiting for the lock
+    if (shared_assets->initialized[img_idx].load(std::memory_order_relaxed))
         return;
 
     int type = img_idx % MAX_ASSETS;
@@ -97,6 +177,7 @@ void BasicAbstractGame::initialize_asset_if_necessary(int img_idx) {
     }
 
     if (names.size() == 0) {
+        RandGen asset_rand_gen;
         AssetGen pgen(&asset_rand_gen);
         asset_rand_gen.seed(fixed_asset_seed + type);
 
@@ -112,20 +193,23 @@ void BasicAbstractGame::initialize_asset_if_necessary(int img_idx) {
         aspect_ratio = asset_ptr->width() * 1.0 / asset_ptr->height();
     }
 
-    basic_assets[img_idx] = asset_ptr;
-    asset_aspect_ratios[img_idx] = aspect_ratio;
-    asset_num_themes[type] = num_themes;
+    shared_assets->assets[img_idx] = asset_ptr;
+    shared_assets->aspect_ratios[img_idx] = aspect_ratio;
+    shared_assets->num_themes[type].store(num_themes, std::memory_order_relaxed);
 
     std::shared_ptr<QImage> reflection_ptr(new QImage(asset_ptr->mirrored(true, false)));
-    basic_reflections[img_idx] = reflection_ptr;
+    shared_assets->reflections[img_idx] = reflection_ptr;
+
+    shared_assets->initialized[img_idx].store(true, std::memory_order_release);
 }
 
 void BasicAbstractGame::fill_elem(int x, int y, int dx, int dy, char elem) {
-    for (int j = 0; j < dx; j++) {
-        for (int k = 0; k < dy; k++) {
-            grid.set(x + j, y + k, elem);
-        }
+    if (dx <= 0 || dy <= 0) {
+        return;
     }
+
+    fassert(grid.contains(x, y) && grid.contains(x + dx - 1, y + dy - 1));
+    grid.fill_rect(x, y, dx, dy, elem);
 }
 
 float BasicAbstractGame::get_distance(const std::shared_ptr<Entity> &p0, const std::shared_ptr<Entity> &p1) {
@@ -157,6 +241,8 @@ void BasicAbstractGame::check_grid_collisions(const std::shared_ptr<Entity> &ent
 
             if (grid_type != SPACE) {
                 handle_grid_collision(ent, grid_type, x, y);
+                // the callback can write to any entity
+                entities_synced = false;
             }
         }
     }
@@ -202,28 +288,54 @@ int BasicAbstractGame::get_obj(int idx) {
 
 std::vector<int> BasicAbstractGame::get_cells_with_type(int type) {
     std::vector<int> cells;
+    grid.cells_with_type(type, cells);
+    return cells;
+}
 
-    for (int i = 0; i < grid_size; i++) {
-        if (grid.get_index(i) == type) {
-            cells.push_back(i);
-        }
+/*
+  Number of cells in the rect [x0, x1] x [y0, y1] where get_obj would return type, including cells outside
+  the grid when type is out_of_bounds_object
+*/
+int BasicAbstractGame::count_type_in_rect(int type, int x0, int y0, int x1, int y1) {
+    int cx0 = std::max(x0, 0);
+    int cy0 = std::max(y0, 0);
+    int cx1 = std::min(x1, grid.w - 1);
+    int cy1 = std::min(y1, grid.h - 1);
+
+    int count = 0;
+    int inside = 0;
+
+    if (cx0 <= cx1 && cy0 <= cy1) {
+        count = grid.count_in_rect(type, cx0, cy0, cx1, cy1);
+        inside = (cx1 - cx0 + 1) * (cy1 - cy0 + 1);
     }
 
-    return cells;
+    if (type == out_of_bounds_object) {
+        count += (x1 - x0 + 1) * (y1 - y0 + 1) - inside;
+    }
+
+    return count;
+}
+
+void BasicAbstractGame::get_type_rows(int type, std::vector<uint64_t> &rows, int *words_per_row) {
+    grid.type_rows(type, rows);
+    *words_per_row = grid.row_words();
 }
 
 void BasicAbstractGame::set_obj(int idx, int elem) {
+    fassert(grid.contains_index(idx));
     grid.set_index(idx, elem);
 }
 
 void BasicAbstractGame::set_obj(int x, int y, int elem) {
+    fassert(grid.contains(x, y));
     grid.set(x, y, elem);
 }
 
 std::shared_ptr<Entity> BasicAbstractGame::spawn_child(const std::shared_ptr<Entity> &src, int type, float obj_r, bool match_vel) {
     float vx = match_vel ? src->vx : 0;
     float vy = match_vel ? src->vy : 0;
-    auto child = std::make_shared<Entity>(src->x, src->y, vx, vy, obj_r, type);
+    auto child = make_entity(src->x, src->y, vx, vy, obj_r, obj_r, type);
     entities.push_back(child);
     return child;
 }
@@ -252,7 +364,7 @@ bool BasicAbstractGame::push_obj(const std::shared_ptr<Entity> &src, const std::
 
     // Rare numerical conditions (dependent on POS_EPS) could cause infinite loops.
     // For now we break quit after a small depth.
-    if (depth < 5) {
+    if (depth < MAX_PUSH_DEPTH) {
         block = sub_step(target, t_vx, t_vy, depth + 1);
     }
 
@@ -265,7 +377,32 @@ bool BasicAbstractGame::push_obj(const std::shared_ptr<Entity> &src, const std::
     return block;
 }
 
+/*
+  Lookups used by sub_step and sweep_step, which are compiled once with the collision policy table and once
+  with the is_blocked and will_reflect virtuals
+*/
+template <bool use_policy>
+bool BasicAbstractGame::policy_is_blocked(const std::shared_ptr<Entity> &src, int target, bool is_horizontal) {
+    if (use_policy)
+        return collision_table.blocks(src->type, target, out_of_bounds_object);
+    return is_blocked(src, target, is_horizontal);
+}
+
+template <bool use_policy>
+bool BasicAbstractGame::policy_will_reflect(int src, int target) {
+    if (use_policy)
+        return collision_table.reflects(src, target, out_of_bounds_object);
+    return will_reflect(src, target);
+}
+
 bool BasicAbstractGame::sub_step(const std::shared_ptr<Entity> &obj, float _vx, float _vy, int depth) {
+    if (has_collision_policy)
+        return sub_step_impl<true>(obj, _vx, _vy, depth);
+    return sub_step_impl<false>(obj, _vx, _vy, depth);
+}
+
+template <bool use_policy>
+bool BasicAbstractGame::sub_step_impl(const std::shared_ptr<Entity> &obj, float _vx, float _vy, int depth) {
     if (obj->will_erase)
         return false;
 
@@ -282,8 +419,8 @@ bool BasicAbstractGame::sub_step(const std::shared_ptr<Entity> &obj, float _vx,
     for (int i = 0; i < 2; i++) {
         for (int j = 0; j < 2; j++) {
             int type2 = get_obj_from_floats(nx + obj->rx * margin * (2 * i - 1), ny + obj->ry * margin * (2 * j - 1));
-            block = block || is_blocked(obj, type2, is_horizontal);
-            reflect = reflect || will_reflect(obj->type, type2);
+            block = block || policy_is_blocked<use_policy>(obj, type2, is_horizontal);
+            reflect = reflect || policy_will_reflect<use_policy>(obj->type, type2);
         }
     }
 
@@ -332,19 +469,27 @@ bool BasicAbstractGame::sub_step(const std::shared_ptr<Entity> &obj, float _vx,
 
     bool block2 = false;
 
-    for (int i = (int)(entities.size()) - 1; i >= 0; i--) {
-        auto m = entities[i];
+    // push_obj steps the pushed entity from in here, so each depth has its own buffer
+    std::vector<int> &candidates = sub_step_candidates[depth];
+    find_collision_candidates(obj, POS_EPS, candidates);
+
+    for (int c = 0; c < (int)(candidates.size()); c++) {
+        int i = candidates[c];
+        const auto &m = entities[i];
 
         if (m == obj || m->will_erase) {
             continue;
         }
 
+        float prev_x = obj->x;
+        float prev_y = obj->y;
+
         bool curr_block = false;
 
         if (has_collision(obj, m, POS_EPS)) {
             if (is_blocked_ents(obj, m, is_horizontal)) {
                 curr_block = true;
-            } else if (will_reflect(obj->type, m->type)) {
+            } else if (policy_will_reflect<use_policy>(obj->type, m->type)) {
                 if (is_horizontal) {
                     float delx = m->x - obj->x;
                     float rsum = m->rx + obj->rx;
@@ -364,11 +509,146 @@ bool BasicAbstractGame::sub_step(const std::shared_ptr<Entity> &obj, float _vx,
         }
 
         block2 = block2 || curr_block;
+
+        // obj was reflected or pushed, so the remaining entities need to be checked against its new position
+        if (obj->x != prev_x || obj->y != prev_y) {
+            find_collision_candidates_below(obj, POS_EPS, i, candidates);
+            c = -1;
+        }
     }
 
     return block || block2;
 }
 
+/*
+  Continuous collision version of sub_step, moves obj by delta along one axis in a single pass.
+
+  The first grid cell entered by the leading edge of obj that blocks or reflects it is found analytically
+  (using the same inset sample points as sub_step), then the first entity along the swept path that blocks
+  or reflects it. Blocking leaves obj flush against the obstacle, reflection mirrors the remaining motion.
+  Returns the fraction of delta that was travelled before obj was blocked.
+*/
+float BasicAbstractGame::sweep_step(const std::shared_ptr<Entity> &obj, float delta, bool is_horizontal) {
+    if (has_collision_policy)
+        return sweep_step_impl<true>(obj, delta, is_horizontal);
+    return sweep_step_impl<false>(obj, delta, is_horizontal);
+}
+
+template <bool use_policy>
+float BasicAbstractGame::sweep_step_impl(const std::shared_ptr<Entity> &obj, float delta, bool is_horizontal) {
+    if (obj->will_erase || delta == 0)
+        return 1;
+
+    const float margin = 0.98f;
+    // leading edges crossing more cells than this in one step are only checked for the first cells
+    const int max_cells = 1024;
+
+    float &pos = is_horizontal ? obj->x : obj->y;
+    float &vel = is_horizontal ? obj->vx : obj->vy;
+    float r = is_horizontal ? obj->rx : obj->ry;
+    float perp = is_horizontal ? obj->y : obj->x;
+    float perp_r = is_horizontal ? obj->ry : obj->rx;
+    float dir = delta > 0 ? 1 : -1;
+
+    float start = pos;
+    float end = pos + delta;
+    float travelled = 1;
+    bool done = false;
+
+    float lead = pos + dir * r * margin;
+    int lead_cell = int(floor(lead));
+    int last_cell = int(floor(lead + delta));
+    int perp_min = int(floor(perp - perp_r * margin));
+    int perp_max = int(floor(perp + perp_r * margin));
+
+    for (int c = lead_cell + int(dir), k = 0; !done && (c - last_cell) * dir <= 0 && k < max_cells; c += int(dir), k++) {
+        bool block = false;
+        bool reflect = false;
+
+        for (int p = perp_min; p <= perp_max; p++) {
+            int type2 = is_horizontal ? get_obj_from_floats(c + 0.5f, p + 0.5f) : get_obj_from_floats(p + 0.5f, c + 0.5f);
+            block = block || policy_is_blocked<use_policy>(obj, type2, is_horizontal);
+            reflect = reflect || policy_will_reflect<use_policy>(obj->type, type2);
+        }
+
+        // coordinate of the cell edge that the leading edge crosses to enter cell c
+        float boundary = delta > 0 ? c : c + 1;
+
+        if (reflect) {
+            end = end + 2 * (boundary - (end + dir * r));
+            vel = -1 * vel;
+            done = true;
+        } else if (block) {
+            end = boundary - dir * r;
+            if ((end - start) * dir < 0)
+                end = start;
+            travelled = (end - start) / delta;
+            done = true;
+        }
+    }
+
+    // entities touched by the swept rect, with POS_EPS as in sub_step
+    float lo = fmin(start, end);
+    float hi = fmax(start, end);
+    std::vector<int> candidates;
+    if (is_horizontal) {
+        find_collision_candidates_at((lo + hi) / 2, perp, r + (hi - lo) / 2, perp_r, POS_EPS, candidates);
+    } else {
+        find_collision_candidates_at(perp, (lo + hi) / 2, perp_r, r + (hi - lo) / 2, POS_EPS, candidates);
+    }
+
+    int first_hit = -1;
+    float first_gap = 0;
+
+    for (int i : candidates) {
+        const auto &m = entities[i];
+
+        if (m == obj || m->will_erase) {
+            continue;
+        }
+
+        float rsum = r + (is_horizontal ? m->rx : m->ry);
+        float dist = ((is_horizontal ? m->x : m->y) - start) * dir;
+
+        // only entities ahead of obj can be entered by moving towards them
+        float m_perp = is_horizontal ? m->y : m->x;
+        float m_perp_r = is_horizontal ? m->ry : m->rx;
+        if (dist <= 0 || !(fabs(perp - m_perp) < (perp_r + m_perp_r) + POS_EPS)) {
+            continue;
+        }
+
+        if (!is_blocked_ents(obj, m, is_horizontal) && !policy_will_reflect<use_policy>(obj->type, m->type)) {
+            continue;
+        }
+
+        float gap = dist - rsum - POS_EPS;
+        if (first_hit < 0 || gap < first_gap) {
+            first_hit = i;
+            first_gap = gap;
+        }
+    }
+
+    if (first_hit >= 0 && first_gap < (end - start) * dir) {
+        const auto &m = entities[first_hit];
+        float rsum = r + (is_horizontal ? m->rx : m->ry);
+        float m_pos = is_horizontal ? m->x : m->y;
+
+        if (is_blocked_ents(obj, m, is_horizontal)) {
+            end = m_pos - dir * rsum;
+            vel = 0;
+            travelled = 0;
+        } else {
+            float del = m_pos - end;
+            end += delta > 0 ? -2 * (rsum - del) : 2 * (rsum + del);
+            vel = -1 * vel;
+        }
+    }
+
+    pos = end;
+
+    return travelled;
+}
+
 /*
   Can be overridden to specify world dimensions different than the default on level generation.
 */
@@ -460,6 +740,9 @@ QColor BasicAbstractGame::color_for_type(int type) {
   Determines whether objects of type target block objects of type src.
 */
 bool BasicAbstractGame::is_blocked(const std::shared_ptr<Entity> &src, int target, bool is_horizontal) {
+    if (has_collision_policy)
+        return collision_table.blocks(src->type, target, out_of_bounds_object);
+
     if (target == WALL_OBJ)
         return true;
     if (target == out_of_bounds_object)
@@ -473,9 +756,21 @@ bool BasicAbstractGame::is_blocked_ents(const std::shared_ptr<Entity> &src, cons
 }
 
 bool BasicAbstractGame::will_reflect(int src, int target) {
+    if (has_collision_policy)
+        return collision_table.reflects(src, target, out_of_bounds_object);
+
     return false;
 }
 
+/*
+  Replaces is_blocked and will_reflect with static rules, see collision-policy.h. Only for games that
+  override neither of them.
+*/
+void BasicAbstractGame::set_collision_policy(CollisionRules blocks, CollisionRules reflects) {
+    collision_table.build(blocks, reflects);
+    has_collision_policy = true;
+}
+
 float BasicAbstractGame::get_agent_acceleration_scale() {
     return 1.0;
 }
@@ -486,7 +781,8 @@ float BasicAbstractGame::get_agent_acceleration_scale() {
 */
 
 std::shared_ptr<Entity> BasicAbstractGame::spawn_entity_rxy(float rx, float ry, int type, float x, float y, float w, float h, bool check_collisions) {
-    std::shared_ptr<Entity> ent(new Entity(0, 0, 0, 0, rx, ry, type));
+    PROFILE_LEVELGEN_PHASE(LEVELGEN_SPAWN);
+    auto ent = make_entity(0, 0, 0, 0, rx, ry, type);
 
     reposition(ent, x, y, w, h, check_collisions);
 
@@ -496,8 +792,35 @@ std::shared_ptr<Entity> BasicAbstractGame::spawn_entity_rxy(float rx, float ry,
 }
 
 bool BasicAbstractGame::agent_has_collision() {
-    for (auto ent : entities) {
-        if (has_agent_collision(ent)) {
+    // games can call this between writes to any entity
+    entities_synced = false;
+    bool collides = agent_collides();
+    entities_synced = false;
+
+    return collides;
+}
+
+bool BasicAbstractGame::agent_collides() {
+    if (uses_direct_scan()) {
+        for (const auto &ent : entities) {
+            if (has_agent_collision(ent)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<int> candidates;
+    find_collision_candidates(agent, 0, candidates);
+
+    // has_agent_collision uses the margin of the other entity, so widen the search by the largest one
+    float margin = entity_store.max_collision_margin;
+    if (margin > 0) {
+        find_collision_candidates(agent, margin, candidates);
+    }
+
+    for (int i : candidates) {
+        if (has_agent_collision(entities[i])) {
             return true;
         }
     }
@@ -505,17 +828,62 @@ bool BasicAbstractGame::agent_has_collision() {
     return false;
 }
 
+const std::shared_ptr<Entity> &BasicAbstractGame::get_agent() {
+    return agent;
+}
+
+/*
+  Velocity that game_step gives the agent for action act when grid_step is set. This goes through
+  set_action_xy, which overwrites the action fields, so it must not be called on a game that is in use.
+*/
+void BasicAbstractGame::grid_step_velocity(int act, float *vx, float *vy) {
+    set_action_xy(act >= 9 ? 4 : act % 9);
+    *vx = action_vx;
+    *vy = action_vy;
+}
+
+/*
+  Games whose game_step does nothing but move the agent with grid_step, and apply the returned rules when it
+  enters a cell, can return true here to be stepped by GridBatch
+*/
+bool BasicAbstractGame::get_grid_batch_rules(std::vector<GridBatchRule> &rules) {
+    return false;
+}
+
+/*
+  Games that flip the agent's image with the direction it moves in do it here, GridBatch calls this with the
+  x velocity of the last action that had one when it writes the agent back
+*/
+void BasicAbstractGame::set_agent_facing(float vx) {
+}
+
 void BasicAbstractGame::reposition_agent() {
+    PROFILE_LEVELGEN_PHASE(LEVELGEN_SPAWN);
+    if (options.use_fast_level_generation && place_in_free_space(agent, 0, 0, main_width, main_height, false)) {
+        return;
+    }
+
     int count = 0;
 
+    // only the agent moves in the loop, so the entities are synced once
+    entities_synced = false;
+
     do {
         agent->x = rand_gen.rand01() * (main_width - 2 * agent->rx) + agent->rx;
         agent->y = rand_gen.rand01() * (main_height - 2 * agent->ry) + agent->ry;
+        entity_moved(agent);
         count++;
-    } while (agent_has_collision() && (count < 100));
+    } while (agent_collides() && (count < 100));
+
+    entities_synced = false;
 }
 
 void BasicAbstractGame::reposition(const std::shared_ptr<Entity> &ent, float x, float y, float w, float h, bool check_collisions) {
+    PROFILE_LEVELGEN_PHASE(LEVELGEN_SPAWN);
+    if (options.use_fast_level_generation && place_in_free_space(ent, x, y, w, h, check_collisions)) {
+        return;
+    }
+
     float rx = ent->rx;
     float ry = ent->ry;
 
@@ -524,35 +892,128 @@ void BasicAbstractGame::reposition(const std::shared_ptr<Entity> &ent, float x,
 
     int count = 0;
 
-    while ((has_agent_collision(ent) || (check_collisions && has_any_collision(ent))) && (count < 100)) {
+    // only ent moves in the loop, so the entities are synced once
+    entities_synced = false;
+
+    bool collides = has_agent_collision(ent) || (check_collisions && has_any_collision_synced(ent, 0, false));
+
+    while (collides && (count < 100)) {
         ent->x = rand_pos(rx, x, x + w);
         ent->y = rand_pos(ry, y, y + h);
+        entity_moved(ent);
+        collides = has_agent_collision(ent) || (check_collisions && has_any_collision_synced(ent, 0, false));
         count++;
     }
 
-    if (count == 100) {
-        printf("WARNING: excessive randomization attempts. Game num, type, rx, ry, w, h: %d %d %f_%f %d %d \n", game_n, ent->type, rx, ry, main_width, main_height);
-        printf("Agent: %f %f\n", agent->x, agent->y);
+    // if every try collided, ent keeps the last position, the game goes on with the overlap as it always has
+    entities_synced = false;
+}
+
+/*
+  use_fast_level_generation version of reposition and reposition_agent, ent is placed uniformly at random
+  among the positions where it has no collision, without trying random positions until one is free. Returns
+  false if no free position was found, the callers then fall back to trying random positions.
+
+  The free space map is kept between calls with the same arguments, so spawning many entities in a row
+  only adds the entities spawned since the last call. Games move entities by writing to them directly, so
+  the map is rebuilt when any entity it was built from is no longer where it was, or has changed its size
+  or collision fields. Otherwise the free space would be wrong and the placement no longer uniform.
+*/
+bool BasicAbstractGame::place_in_free_space(const std::shared_ptr<Entity> &ent, float x, float y, float w, float h, bool check_collisions) {
+    bool is_agent = ent == agent;
+    float rx = ent->rx;
+    float ry = ent->ry;
+
+    std::array<float, 11> key = {x, y, w, h, rx, ry, ent->collision_margin, float(is_agent), float(check_collisions), agent->x, agent->y};
+    size_t num_entities = entities.size();
+    bool reuse = placement_map_valid && key == placement_key && placement_obstacles.size() <= num_entities;
+
+    for (size_t i = 0; reuse && i < placement_obstacles.size(); i++) {
+        reuse = placement_obstacles[i] == PlacementObstacle(*entities[i]);
+    }
+
+    if (!reuse) {
+        float x0 = w <= 2 * rx ? x + w / 2 : x + rx;
+        float x1 = w <= 2 * rx ? x + w / 2 : x + w - rx;
+        float y0 = h <= 2 * ry ? y + h / 2 : y + ry;
+        float y1 = h <= 2 * ry ? y + h / 2 : y + h - ry;
+        placement_map.reset(x0, y0, x1, y1, std::min(rx, ry));
+        placement_key = key;
+        placement_obstacles.clear();
+        placement_map_valid = true;
+
+        if (!is_agent && ent->type != PLAYER) {
+            float margin = ent->collision_margin;
+            placement_map.block(agent->x, agent->y, rx + agent->rx + margin, ry + agent->ry + margin);
+        }
+    }
+
+    // the same collisions that reposition and reposition_agent check for
+    for (size_t i = placement_obstacles.size(); i < num_entities; i++) {
+        const auto &e = entities[i];
+        placement_obstacles.push_back(PlacementObstacle(*e));
+
+        if (is_agent) {
+            if (e->type != PLAYER) {
+                placement_map.block(e->x, e->y, rx + e->rx + e->collision_margin, ry + e->ry + e->collision_margin);
+            }
+        } else if (check_collisions && !e->avoids_collisions) {
+            placement_map.block(e->x, e->y, rx + e->rx, ry + e->ry);
+        }
     }
+
+    // only ent moves in the loop, so the entities are synced once
+    entities_synced = false;
+    bool placed = false;
+
+    for (int count = 0; count < 100 && !placed; count++) {
+        if (!placement_map.sample(rand_gen, &ent->x, &ent->y)) {
+            break;
+        }
+        entity_moved(ent);
+
+        placed = !(is_agent ? agent_collides() : (has_agent_collision(ent) || (check_collisions && has_any_collision_synced(ent, 0, false))));
+    }
+
+    entities_synced = false;
+
+    return placed;
+}
+
+BasicAbstractGame::PlacementObstacle::PlacementObstacle(const Entity &e)
+    : ent(&e), x(e.x), y(e.y), rx(e.rx), ry(e.ry), collision_margin(e.collision_margin), type(e.type), avoids_collisions(e.avoids_collisions) {
+}
+
+bool BasicAbstractGame::PlacementObstacle::operator==(const PlacementObstacle &other) const {
+    return ent == other.ent && x == other.x && y == other.y && rx == other.rx && ry == other.ry && collision_margin == other.collision_margin &&
+           type == other.type && avoids_collisions == other.avoids_collisions;
 }
 
 std::shared_ptr<Entity> BasicAbstractGame::spawn_entity(float r, int type, float x, float y, float w, float h, bool check_collisions) {
     return spawn_entity_rxy(r, r, type, x, y, w, h, check_collisions);
 }
 
+/*
+  Allocates an entity from this game's pool without adding it to the game, use this instead of make_shared
+*/
+std::shared_ptr<Entity> BasicAbstractGame::make_entity(float x, float y, float vx, float vy, float rx, float ry, int type) {
+    return std::allocate_shared<Entity>(EntityPoolAllocator<Entity>(entity_pool), x, y, vx, vy, rx, ry, type);
+}
+
 std::shared_ptr<Entity> BasicAbstractGame::add_entity(float x, float y, float vx, float vy, float r, int type) {
-    std::shared_ptr<Entity> ent(new Entity(x, y, vx, vy, r, r, type));
+    auto ent = make_entity(x, y, vx, vy, r, r, type);
     entities.push_back(ent);
     return ent;
 }
 
 std::shared_ptr<Entity> BasicAbstractGame::add_entity_rxy(float x, float y, float vx, float vy, float rx, float ry, int type) {
-    std::shared_ptr<Entity> ent(new Entity(x, y, vx, vy, rx, ry, type));
+    auto ent = make_entity(x, y, vx, vy, rx, ry, type);
     entities.push_back(ent);
     return ent;
 }
 
 std::shared_ptr<Entity> BasicAbstractGame::spawn_entity_at_idx(int idx, float r, int type) {
+    PROFILE_LEVELGEN_PHASE(LEVELGEN_SPAWN);
     float x = (idx % main_width) + .5;
     float y = (idx / main_width) + .5;
 
@@ -568,6 +1029,17 @@ void BasicAbstractGame::spawn_entities(int num_entities, float r, int type, floa
 }
 
 void BasicAbstractGame::basic_step_object(const std::shared_ptr<Entity> &obj) {
+    // games can call this between writes to any entity
+    entities_synced = false;
+    step_object(obj);
+    entities_synced = false;
+}
+
+/*
+  basic_step_object without the full sync, only obj moves until this returns and sub_step never checks obj
+  against itself, so the synced fields of every other entity stay valid
+*/
+void BasicAbstractGame::step_object(const std::shared_ptr<Entity> &obj) {
     if (obj->will_erase)
         return;
 
@@ -600,6 +1072,25 @@ void BasicAbstractGame::basic_step_object(const std::shared_ptr<Entity> &obj) {
             step_x_first = false;
     }
 
+    if (options.use_continuous_collision && !grid_step) {
+        float vx = obj->vx;
+        float vy = obj->vy;
+        float x_pct, y_pct;
+
+        if (step_x_first) {
+            x_pct = sweep_step(obj, vx, true);
+            y_pct = sweep_step(obj, vy, false);
+        } else {
+            y_pct = sweep_step(obj, vy, false);
+            x_pct = sweep_step(obj, vx, true);
+        }
+
+        obj->vx *= x_pct;
+        obj->vy *= y_pct;
+
+        return;
+    }
+
     float vx_pct = 0;
     float vy_pct = 0;
 
@@ -693,63 +1184,274 @@ void BasicAbstractGame::game_step() {
 
     step_entities(entities);
 
-    for (int i = (int)(entities.size()) - 1; i >= 0; i--) {
-        auto ent = entities[i];
+    std::vector<int> candidates;
+    entities_synced = false;
 
-        if (has_agent_collision(ent)) {
+    // callbacks can add entities, which may reallocate entities, so entities[i] is read again after every
+    // callback and each callback is passed its own copy of the pointer. Entities are only erased after this pass.
+    for (int i = (int)(entities.size()) - 1; i >= 0; i--) {
+        if (has_agent_collision(entities[i]) && is_reported_contact(entities[i], agent)) {
+            auto ent = entities[i];
+            entities_synced = false;
             handle_agent_collision(ent);
+            entities_synced = false;
         }
 
-        if (ent->collides_with_entities) {
-            for (int j = (int)(entities.size()) - 1; j >= 0; j--) {
+        if (entities[i]->collides_with_entities) {
+            // entities added by callbacks during this pass are not checked against entities[i]
+            int max_j = (int)(entities.size()) - 1;
+            find_collision_candidates_below(entities[i], entities[i]->collision_margin, max_j, candidates);
+
+            for (int c = 0; c < (int)(candidates.size()); c++) {
+                int j = candidates[c];
                 if (i == j)
                     continue;
-                auto ent2 = entities[j];
 
-                if (has_collision(ent, ent2, ent->collision_margin) && !ent->will_erase && !ent2->will_erase) {
-                    handle_collision(ent, ent2);
+                if (has_collision(entities[i], entities[j], entities[i]->collision_margin) && !entities[i]->will_erase && !entities[j]->will_erase) {
+                    auto ent = entities[i];
+                    auto ent2 = entities[j];
+
+                    entities_synced = false;
+                    if (is_reported_contact(ent, ent2)) {
+                        handle_collision(ent, ent2);
+                    }
+                    entities_synced = false;
+
+                    find_collision_candidates_below(ent, ent->collision_margin, j - 1, candidates);
+                    c = -1;
                 }
             }
         }
 
-        if (ent->smart_step) {
+        if (entities[i]->smart_step) {
+            auto ent = entities[i];
             check_grid_collisions(ent);
         }
     }
 
+    entities_synced = false;
+
     erase_if_needed();
 
+    if (report_contact_begin_only) {
+        contact_tracker.end_step(ended_contacts);
+
+        for (const auto &contact : ended_contacts) {
+            handle_contact_end(contact.src, contact.target);
+        }
+    }
+
     step_data.done = step_data.done || is_out_of_bounds(agent);
 }
 
+/*
+  Whether the collision callbacks should be called for a contact found during game_step, which is always
+  unless report_contact_begin_only is set
+*/
+bool BasicAbstractGame::is_reported_contact(const std::shared_ptr<Entity> &src, const std::shared_ptr<Entity> &target) {
+    if (!report_contact_begin_only)
+        return true;
+
+    // ended contacts are reported in handle order, so handles are given out in entity order as a sync would
+    if (src->handle.slot < 0 || target->handle.slot < 0) {
+        for (const auto &ent : entities) {
+            get_handle(ent);
+        }
+    }
+
+    return contact_tracker.add(get_handle(src), get_handle(target));
+}
+
+/*
+  Called at the end of game_step for each contact that began in an earlier step and was not found in this
+  one, only when report_contact_begin_only is set. Either entity may have been erased, in which case
+  get_entity returns nullptr for its handle.
+*/
+void BasicAbstractGame::handle_contact_end(EntityHandle src, EntityHandle target) {
+}
+
+/*
+  Removes erased entities in a single pass, keeping the remaining entities in order
+*/
 void BasicAbstractGame::erase_if_needed() {
-    for (int i = (int)(entities.size()) - 1; i >= 0; i--) {
-        auto e = entities[i];
+    size_t num_kept = 0;
+
+    for (size_t i = 0; i < entities.size(); i++) {
+        auto &e = entities[i];
 
         if (e->will_erase || (e->auto_erase && is_out_of_bounds(e))) {
-            entities.erase(entities.begin() + i);
+            entity_store.release(e);
+            placement_map_valid = false;
+            entities_synced = false;
+            continue;
+        }
+
+        if (num_kept != i) {
+            entities[num_kept] = std::move(e);
         }
+        num_kept++;
     }
+
+    entities.resize(num_kept);
 }
 
-void BasicAbstractGame::game_reset() {
+bool BasicAbstractGame::level_cache_fields(LevelFields &fields) {
+    return false;
+}
+
+bool BasicAbstractGame::supports_level_cache() {
+    LevelFields probe;
+    return !use_procgen_background && level_cache_fields(probe);
+}
+
+bool BasicAbstractGame::load_cached_level() {
+    if ((options.level_cache_mb == 0 && level_pack == nullptr) || !supports_level_cache()) {
+        return false;
+    }
+
+    if (options.level_cache_mb > 0) {
+        auto level = LevelCache::shared().find(level_options_hash, current_level_seed);
+        if (level != nullptr) {
+            restore_level(*level);
+            return true;
+        }
+    }
+
+    if (level_pack != nullptr) {
+        CachedLevel level;
+        if (level_pack->read(current_level_seed, &level)) {
+            restore_level(level);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void BasicAbstractGame::save_cached_level() {
+    if (options.level_cache_mb == 0) {
+        return;
+    }
+
+    auto level = std::make_shared<CachedLevel>();
+    if (capture_level(level.get())) {
+        LevelCache::shared().insert(level_options_hash, current_level_seed, level);
+    }
+}
+
+void BasicAbstractGame::restore_level(const CachedLevel &level) {
+    // games set constants such as maxspeed here, an env may never have run game_reset before
+    // its random draws don't matter, rand_gen is restored below
     choose_world_dim();
+
+    main_width = level.main_width;
+    main_height = level.main_height;
+    grid_size = main_width * main_height;
+    grid.resize(main_width, main_height);
+    for (int i = 0; i < grid_size; i++) {
+        grid.set_index(i, level.cells[i]);
+    }
+
+    background_index = level.background_index;
+    bg_pct_x = level.bg_pct_x;
+    out_of_bounds_object = level.out_of_bounds_object;
+    visibility = level.visibility;
+    grid_step = level.grid_step;
+    std::copy(level.level_stats, level.level_stats + NUM_LEVEL_STATS, level_stats);
+
+    entities.clear();
+    entity_store.clear();
+    spatial_hash.clear();
+    entities_synced = false;
+    placement_map_valid = false;
+    contact_tracker.clear();
+
+    for (const Entity &cached : level.entities) {
+        auto ent = make_entity(0, 0, 0, 0, 0, 0, 0);
+        *ent = cached;
+        ent->handle = EntityHandle();
+        entities.push_back(ent);
+    }
+    agent = entities[level.agent_idx];
+
+    rand_gen.copy_state(level.rand_gen);
+
+    LevelFields fields(&level);
+    level_cache_fields(fields);
+}
+
+bool BasicAbstractGame::capture_level(CachedLevel *level) {
+    if (!supports_level_cache()) {
+        return false;
+    }
+
+    level->main_width = main_width;
+    level->main_height = main_height;
+    level->cells.resize(grid_size);
+    for (int i = 0; i < grid_size; i++) {
+        level->cells[i] = grid.get_index(i);
+    }
+
+    level->agent_idx = -1;
+    level->entities.clear();
+    level->entities.reserve(entities.size());
+    for (const auto &ent : entities) {
+        if (ent == agent) {
+            level->agent_idx = (int)(level->entities.size());
+        }
+        level->entities.push_back(*ent);
+    }
+    fassert(level->agent_idx >= 0);
+
+    level->background_index = background_index;
+    level->bg_pct_x = bg_pct_x;
+    level->out_of_bounds_object = out_of_bounds_object;
+    level->visibility = visibility;
+    level->grid_step = grid_step;
+    std::copy(level_stats, level_stats + NUM_LEVEL_STATS, level->level_stats);
+    level->rand_gen.copy_state(rand_gen);
+
+    level->ints.clear();
+    level->floats.clear();
+    LevelFields fields(level);
+    level_cache_fields(fields);
+
+    return true;
+}
+
+void BasicAbstractGame::game_reset() {
+    PROFILE_LEVELGEN_PHASE(LEVELGEN_SETUP);
+
+    {
+        PROFILE_LEVELGEN_PHASE(LEVELGEN_WORLD_DIM);
+        choose_world_dim();
+    }
     fassert(main_width > 0 && main_height > 0);
 
     bg_pct_x = rand_gen.rand01();
 
     grid_size = main_width * main_height;
-    grid.resize(main_width, main_height);
+    if (empty_grid.w != main_width || empty_grid.h != main_height) {
+        empty_grid.resize(main_width, main_height);
+        empty_grid.fill_rect(0, 0, main_width, main_height, SPACE);
+    }
+    // the copy reuses the storage of the previous level, where resize would allocate it again
+    grid = empty_grid;
 
     background_index = rand_gen.randn((int)(main_bg_images_ptr->size()));
 
     AssetGen bggen(&rand_gen);
 
     if (use_procgen_background) {
+        PROFILE_LEVELGEN_PHASE(LEVELGEN_BACKGROUND);
         bggen.generate_resource(main_bg_images_ptr->at(background_index));
     }
 
     entities.clear();
+    entity_store.clear();
+    spatial_hash.clear();
+    placement_map_valid = false;
+    contact_tracker.clear();
 
     float ax, ay;
     float a_r = 0.4f;
@@ -762,15 +1464,13 @@ void BasicAbstractGame::game_reset() {
         ay = a_r;
     }
 
-    auto _agent = std::make_shared<Entity>(ax, ay, 0, 0, a_r, PLAYER);
+    auto _agent = make_entity(ax, ay, 0, 0, a_r, a_r, PLAYER);
     agent = _agent;
     agent->smart_step = true;
     agent->render_z = 1;
     entities.push_back(agent);
 
     erase_if_needed();
-
-    fill_elem(0, 0, main_width, main_height, SPACE);
 }
 
 QRectF BasicAbstractGame::get_screen_rect(float x, float y, float dx, float dy, float render_eps) {
@@ -847,7 +1547,7 @@ void BasicAbstractGame::tile_image(QPainter &p, QImage *image, const QRectF &rec
 
 QImage *BasicAbstractGame::lookup_asset(int img_idx, bool is_reflected) {
     initialize_asset_if_necessary(img_idx);
-    auto assets = is_reflected ? &basic_reflections : &basic_assets;
+    auto assets = is_reflected ? &shared_assets->reflections : &shared_assets->assets;
     return assets->at(img_idx).get();
 }
 
@@ -894,7 +1594,9 @@ void BasicAbstractGame::draw_grid_obj(QPainter &p, const QRectF &rect, int type)
 void BasicAbstractGame::draw_foreground(QPainter &p, const QRect &rect) {
     prepare_for_drawing(rect.height());
 
-    draw_entities(p, entities, -1);
+    find_visible_entities();
+
+    draw_visible_entities(p, -1);
 
     int low_x, high_x, low_y, high_y;
 
@@ -927,8 +1629,8 @@ void BasicAbstractGame::draw_foreground(QPainter &p, const QRect &rect) {
         }
     }
 
-    draw_entities(p, entities, 0);
-    draw_entities(p, entities, 1);
+    draw_visible_entities(p, 0);
+    draw_visible_entities(p, 1);
 
     if (has_useful_vel_info && (options.paint_vel_info)) {
         float infodim = rect.height() * .2;
@@ -985,9 +1687,9 @@ void BasicAbstractGame::match_aspect_ratio(const std::shared_ptr<Entity> &ent, b
     initialize_asset_if_necessary(img_idx);
 
     if (match_width) {
-        ent->ry = ent->rx / asset_aspect_ratios[img_idx];
+        ent->ry = ent->rx / shared_assets->aspect_ratios[img_idx];
     } else {
-        ent->rx = ent->ry * asset_aspect_ratios[img_idx];
+        ent->rx = ent->ry * shared_assets->aspect_ratios[img_idx];
     }
 }
 
@@ -995,7 +1697,7 @@ void BasicAbstractGame::fit_aspect_ratio(const std::shared_ptr<Entity> &ent) {
     int img_idx = ent->image_type + ent->image_theme * MAX_ASSETS;
     initialize_asset_if_necessary(img_idx);
 
-    float ar = asset_aspect_ratios[img_idx];
+    float ar = shared_assets->aspect_ratios[img_idx];
 
     if (ar > 1) {
         ent->ry = ent->rx / ar;
@@ -1006,12 +1708,12 @@ void BasicAbstractGame::fit_aspect_ratio(const std::shared_ptr<Entity> &ent) {
 
 void BasicAbstractGame::choose_random_theme(const std::shared_ptr<Entity> &ent) {
     initialize_asset_if_necessary(ent->image_type);
-    ent->image_theme = rand_gen.randn(asset_num_themes[ent->image_type]);
+    ent->image_theme = rand_gen.randn(shared_assets->num_themes[ent->image_type].load(std::memory_order_relaxed));
 }
 
 void BasicAbstractGame::choose_step_random_theme(const std::shared_ptr<Entity> &ent) {
     initialize_asset_if_necessary(ent->image_type);
-    ent->image_theme = step_rand_int % asset_num_themes[ent->image_type];
+    ent->image_theme = step_rand_int % shared_assets->num_themes[ent->image_type].load(std::memory_order_relaxed);
 }
 
 bool BasicAbstractGame::should_draw_entity(const std::shared_ptr<Entity> &entity) {
@@ -1034,6 +1736,54 @@ void BasicAbstractGame::draw_entities(QPainter &p, const std::vector<std::shared
     }
 }
 
+/*
+  Conservative test for whether any part of an entity could be drawn inside the view window.
+  Image adjustments and rotation can extend the drawn image past the entity's own rect, so the
+  rect is padded by its full size plus a margin of one cell, like the grid in draw_foreground.
+*/
+bool BasicAbstractGame::may_be_visible(const std::shared_ptr<Entity> &entity) {
+    if (!options.center_agent || entity->use_abs_coords) {
+        return true;
+    }
+
+    float margin = view_dim / 2 + 2 * (entity->rx + entity->ry) + 1;
+
+    return fabs(entity->x - center_x) <= margin && fabs(entity->y - center_y) <= margin;
+}
+
+/*
+  Sorts the entities that may be visible by render_z in a single pass, keeping their relative order.
+
+  The pass visits every entity rather than querying the view rect through the spatial hash. may_be_visible
+  is a per-entity hook that keeps entities drawn at fixed screen positions wherever they are in the world,
+  which a position query would miss. The hash is also not built for games with few entities, and a view of
+  16 cells padded by the entity sizes covers more cells than a query scans before returning every entity.
+  The test is a few compares per entity once per frame, the time saved is in the entities it does not draw.
+*/
+void BasicAbstractGame::find_visible_entities() {
+    for (auto &idxs : visible_entity_idxs) {
+        idxs.clear();
+    }
+
+    for (int i = 0; i < (int)(entities.size()); i++) {
+        const auto &ent = entities[i];
+
+        if (ent->render_z < -1 || ent->render_z > 1) {
+            continue;
+        }
+
+        if (may_be_visible(ent)) {
+            visible_entity_idxs[ent->render_z + 1].push_back(i);
+        }
+    }
+}
+
+void BasicAbstractGame::draw_visible_entities(QPainter &p, int render_z) {
+    for (int idx : visible_entity_idxs[render_z + 1]) {
+        draw_entity(p, entities[idx]);
+    }
+}
+
 bool BasicAbstractGame::is_out_of_bounds(const std::shared_ptr<Entity> &e1) {
     float x = e1->x;
     float y = e1->y;
@@ -1055,15 +1805,22 @@ bool BasicAbstractGame::is_out_of_bounds(const std::shared_ptr<Entity> &e1) {
 void BasicAbstractGame::step_entities(const std::vector<std::shared_ptr<Entity>> &given) {
     int entities_count = (int)(given.size());
 
+    // synced once by the first collision query, after that only the entity being stepped moves
+    entities_synced = false;
+
+    // nothing in the loop adds or removes entities, so ent can refer into given
     for (int i = entities_count - 1; i >= 0; i--) {
-        auto ent = given.at(i);
+        const auto &ent = given[i];
 
         if (ent->smart_step) {
-            basic_step_object(ent);
+            step_object(ent);
         }
 
         ent->step();
+        entity_moved(ent);
     }
+
+    entities_synced = false;
 }
 
 float BasicAbstractGame::rand_pos(float r, float min, float max) {
@@ -1081,8 +1838,20 @@ float BasicAbstractGame::rand_pos(float r, float max) {
 }
 
 bool BasicAbstractGame::has_any_collision(const std::shared_ptr<Entity> &e1, float margin, bool exclude_self) {
-    for (int i = (int)(entities.size()) - 1; i >= 0; i--) {
-        auto ent = entities.at(i);
+    // games can call this between writes to any entity
+    entities_synced = false;
+    bool collides = has_any_collision_synced(e1, margin, exclude_self);
+    entities_synced = false;
+
+    return collides;
+}
+
+bool BasicAbstractGame::has_any_collision_synced(const std::shared_ptr<Entity> &e1, float margin, bool exclude_self) {
+    std::vector<int> candidates;
+    find_collision_candidates(e1, margin, candidates);
+
+    for (int i : candidates) {
+        const auto &ent = entities[i];
 
         if (exclude_self && (e1 == ent)){
           continue;
@@ -1109,3 +1878,105 @@ bool BasicAbstractGame::has_collision(const std::shared_ptr<Entity> &e1, const s
 
     return (fabs(e1->x - e2->x) < threshold_x) && (fabs(e1->y - e2->y) < threshold_y);
 }
+
+EntityHandle BasicAbstractGame::get_handle(const std::shared_ptr<Entity> &ent) {
+    return entity_store.get_handle(ent);
+}
+
+/*
+  nullptr once the entity has been erased
+*/
+std::shared_ptr<Entity> BasicAbstractGame::get_entity(EntityHandle handle) {
+    return entity_store.get(handle);
+}
+
+/*
+  Indices of the entities that may satisfy has_collision(ent, other, margin), in descending order, which is
+  the order the collision loops have always visited entities in.
+*/
+void BasicAbstractGame::find_collision_candidates(const std::shared_ptr<Entity> &ent, float margin, std::vector<int> &candidates) {
+    find_collision_candidates_at(ent->x, ent->y, ent->rx, ent->ry, margin, candidates);
+}
+
+void BasicAbstractGame::find_collision_candidates_at(float x, float y, float rx, float ry, float margin, std::vector<int> &candidates) {
+    if (uses_direct_scan()) {
+        scan_collision_candidates(x, y, rx, ry, margin, (int)(entities.size()) - 1, candidates);
+        return;
+    }
+
+    const EntityStore &store = entity_store;
+
+    if (!entities_synced || store.size() != (int)(entities.size())) {
+        entity_store.sync(entities);
+        if (store.size() > overlap_mask_max_entities()) {
+            spatial_hash.sync(entity_store);
+        }
+        entities_synced = true;
+    }
+
+    bool dense_scan = store.size() <= overlap_mask_max_entities();
+
+    // for a few thousand entities a vectorized scan of every entity is faster than the spatial hash
+    if (dense_scan) {
+        int n = store.size();
+        overlap_hits.resize((n + 63) / 64);
+        overlap_mask(x, y, rx, ry, margin, store.x.data(), store.y.data(), store.rx.data(), store.ry.data(), n, overlap_hits.data());
+
+        candidates.clear();
+        mask_to_indices_desc(overlap_hits.data(), n, candidates);
+        return;
+    }
+
+    spatial_hash.query(x, y, rx + margin, ry + margin, candidates);
+}
+
+/*
+  With only a few entities, syncing the entity store and building candidate lists from it costs more than
+  testing every entity, so the collision queries loop over the entities directly and never sync
+*/
+bool BasicAbstractGame::uses_direct_scan() {
+    return (int)(entities.size()) <= DIRECT_SCAN_MAX_ENTITIES;
+}
+
+/*
+  Refreshes the synced fields and the spatial hash cells of ent after it was moved by the engine, so that
+  moving one entity does not cost a full sync. Does nothing while the entities are not synced, or when ent
+  is not one of them.
+*/
+void BasicAbstractGame::entity_moved(const std::shared_ptr<Entity> &ent) {
+    if (!entities_synced || entity_store.size() != (int)(entities.size())) {
+        return;
+    }
+
+    int i = entity_store.index_of(ent->handle);
+    if (i < 0) {
+        return;
+    }
+
+    entity_store.update(i, *ent);
+    if (entity_store.size() > overlap_mask_max_entities()) {
+        spatial_hash.update(entity_store, i);
+    }
+}
+
+void BasicAbstractGame::scan_collision_candidates(float x, float y, float rx, float ry, float margin, int max_idx, std::vector<int> &candidates) {
+    candidates.clear();
+    for (int i = max_idx; i >= 0; i--) {
+        const Entity &m = *entities[i];
+        if ((fabs(x - m.x) < (rx + m.rx) + margin) && (fabs(y - m.y) < (ry + m.ry) + margin)) {
+            candidates.push_back(i);
+        }
+    }
+}
+
+void BasicAbstractGame::find_collision_candidates_below(const std::shared_ptr<Entity> &ent, float margin, int max_idx, std::vector<int> &candidates) {
+    if (uses_direct_scan()) {
+        scan_collision_candidates(ent->x, ent->y, ent->rx, ent->ry, margin, std::min(max_idx, (int)(entities.size()) - 1), candidates);
+        return;
+    }
+
+    find_collision_candidates(ent, margin, candidates);
+
+    auto first = std::lower_bound(candidates.begin(), candidates.end(), max_idx, std::greater<int>());
+    candidates.erase(candidates.begin(), first);
+}
@@ -8,11 +8,45 @@ Base game class used by all currently existing games
 
 #include <set>
 #include <queue>
+#include <atomic>
+#include <array>
 #include "game.h"
 #include "grid.h"
+#include "compact-grid.h"
+#include "entity-pool.h"
+#include "entity-store.h"
+#include "spatial-hash.h"
+#include "collision-policy.h"
+#include "placement-map.h"
+#include "contact-tracker.h"
+#include "grid-batch.h"
+#include "level-cache.h"
 #include "cpp-utils.h"
 
+// push_obj stops pushing chains of entities after this many steps
+const int MAX_PUSH_DEPTH = 5;
+
+/*
+  Loaded assets only depend on the game type and asset options, so a single copy is shared by
+  all games with the same settings. Entries are filled lazily from the stepping threads, an entry
+  may only be read once its initialized flag has been set.
+*/
+struct SharedAssets {
+    std::mutex init_mutex;
+    std::unique_ptr<std::atomic<bool>[]> initialized;
+    std::unique_ptr<std::atomic<int>[]> num_themes;
+    std::vector<std::shared_ptr<QImage>> assets;
+    std::vector<std::shared_ptr<QImage>> reflections;
+    std::vector<float> aspect_ratios;
+
+    SharedAssets();
+    size_t memory_bytes();
+};
+
 class BasicAbstractGame : public Game {
+    // reads the grid and level size directly when copying levels into its arrays
+    friend class GridBatch;
+
   public:
     int grid_size = 0;
 
@@ -24,13 +58,26 @@ class BasicAbstractGame : public Game {
     void game_reset() override;
     void game_draw(QPainter &p, const QRect &rect) override;
     void game_init() override;
+    void memory_usage(MemoryUsage &usage) override;
+    bool load_cached_level() override;
+    void save_cached_level() override;
+    bool capture_level(CachedLevel *level) override;
+
+    // Games that support the LevelCache call fields.field() on every field their game_reset sets other than
+    // the grid, entities, background, out_of_bounds_object, visibility and grid_step, and return true.
+    // Entities must not refer to each other by handle, and the game must not use a procgen background.
+    virtual bool level_cache_fields(LevelFields &fields);
 
     virtual bool is_blocked(const std::shared_ptr<Entity> &src, int target, bool is_horizontal);
     virtual bool is_blocked_ents(const std::shared_ptr<Entity> &src, const std::shared_ptr<Entity> &target, bool is_horizontal);
     virtual bool will_reflect(int src, int target);
+    void set_collision_policy(CollisionRules blocks = CollisionRules(), CollisionRules reflects = CollisionRules());
     virtual void handle_agent_collision(const std::shared_ptr<Entity> &obj);
     virtual void handle_grid_collision(const std::shared_ptr<Entity> &obj, int type, int i, int j);
     virtual void handle_collision(const std::shared_ptr<Entity> &src, const std::shared_ptr<Entity> &target);
+    virtual void handle_contact_end(EntityHandle src, EntityHandle target);
+    virtual bool get_grid_batch_rules(std::vector<GridBatchRule> &rules);
+    virtual void set_agent_facing(float vx);
     virtual float get_agent_acceleration_scale();
     virtual bool use_block_asset(int type);
     virtual float get_tile_aspect_ratio(const std::shared_ptr<Entity> &type);
@@ -42,6 +89,7 @@ class BasicAbstractGame : public Game {
     virtual void draw_grid_obj(QPainter &p, const QRectF &rect, int obj);
     virtual void choose_world_dim();
     virtual bool should_draw_entity(const std::shared_ptr<Entity> &entity);
+    virtual bool may_be_visible(const std::shared_ptr<Entity> &entity);
     virtual void set_action_xy(int move_act);
     virtual void choose_center(float &cx, float &cy);
     virtual void update_agent_velocity();
@@ -57,10 +105,13 @@ class BasicAbstractGame : public Game {
     std::shared_ptr<Entity> spawn_entity_rxy(float rx, float ry, int type, float x, float y, float w, float h, bool check_collisions = true);
     std::shared_ptr<Entity> spawn_entity(float r, int type, float x, float y, float w, float h, bool check_collisions = true);
     std::shared_ptr<Entity> spawn_entity_at_idx(int idx, float r, int type);
+    std::shared_ptr<Entity> make_entity(float x, float y, float vx, float vy, float rx, float ry, int type);
     std::shared_ptr<Entity> add_entity(float x, float y, float vx, float vy, float r, int type);
     std::shared_ptr<Entity> add_entity_rxy(float x, float y, float vx, float vy, float rx, float ry, int type);
     std::shared_ptr<Entity> spawn_child(const std::shared_ptr<Entity> &src, int type, float obj_r, bool match_vel = false);
     void spawn_entities(int num_objects, float r, int type, float x, float y, float w, float h);
+    EntityHandle get_handle(const std::shared_ptr<Entity> &ent);
+    std::shared_ptr<Entity> get_entity(EntityHandle handle);
     void reposition(const std::shared_ptr<Entity> &ent, float x, float y, float w, float h, bool check_collisions);
     int get_obj(int i, int j);
     int get_obj(int idx);
@@ -72,6 +123,9 @@ class BasicAbstractGame : public Game {
     int get_obj_from_floats(float i, float j);
     int get_agent_index();
     std::vector<int> get_cells_with_type(int type);
+    int count_type_in_rect(int type, int x0, int y0, int x1, int y1);
+    // bitset of the cells with the given type, see CompactGrid::type_rows
+    void get_type_rows(int type, std::vector<uint64_t> &rows, int *words_per_row);
 
     void check_grid_collisions(const std::shared_ptr<Entity> &src);
     float get_distance(const std::shared_ptr<Entity> &p0, const std::shared_ptr<Entity> &p1);
@@ -101,17 +155,15 @@ class BasicAbstractGame : public Game {
 
     bool agent_has_collision();
     void reposition_agent();
+    const std::shared_ptr<Entity> &get_agent();
+    void grid_step_velocity(int act, float *vx, float *vy);
 
   protected:
     std::shared_ptr<Entity> agent;
     std::vector<std::shared_ptr<Entity>> entities;
-    std::vector<std::shared_ptr<QImage>> basic_assets;
-    std::vector<std::shared_ptr<QImage>> basic_reflections;
+    std::shared_ptr<SharedAssets> shared_assets;
     std::vector<std::shared_ptr<QImage>> *main_bg_images_ptr;
 
-    std::vector<float> asset_aspect_ratios;
-    std::vector<int> asset_num_themes;
-
     bool use_procgen_background = false;
     int background_index = 0;
     float bg_tile_ratio = 0.0f;
@@ -133,11 +185,12 @@ class BasicAbstractGame : public Game {
     float center_y = 0.0f;
 
     bool random_agent_start = true;
+    // handle_agent_collision and handle_collision are only called in the first step of each contact rather
+    // than every step it lasts, and handle_contact_end is called when it ends
+    bool report_contact_begin_only = false;
     bool has_useful_vel_info = false;
     int step_rand_int = 0;
 
-    RandGen asset_rand_gen;
-
     int main_width = 0;
     int main_height = 0;
     int out_of_bounds_object = 0;
@@ -151,15 +204,83 @@ class BasicAbstractGame : public Game {
 
     virtual void draw_entity(QPainter &p, const std::shared_ptr<Entity> &to_draw);
   private:
-    Grid<int> grid;
+    CompactGrid grid;
+    // a grid of main_width x main_height filled with SPACE, copied into grid at the start of every reset
+    CompactGrid empty_grid;
+
+    // collision-query mirror of the entities and the broadphase built on it, only trusted while
+    // entities_synced is set. Games can write to any entity at any time, so the flag is cleared on exit from
+    // every function that sets it and after every game callback. In between, the stepping and placement
+    // loops call entity_moved for the one entity they move instead of syncing everything again. With few
+    // entities, see uses_direct_scan, neither is used and collision queries loop over the entities.
+    EntityStore entity_store;
+    std::shared_ptr<EntityPool> entity_pool = std::make_shared<EntityPool>();
+    SpatialHash spatial_hash;
+    std::vector<uint64_t> overlap_hits;
+    bool entities_synced = false;
+    // collision candidates of sub_step, reused across calls, one per push depth
+    std::vector<int> sub_step_candidates[MAX_PUSH_DEPTH + 1];
+
+    // indices into entities of the entities that may be on screen, for render_z -1, 0 and 1
+    std::vector<int> visible_entity_idxs[3];
 
     QImage *lookup_asset(int img_idx, bool is_reflected = false);
     void initialize_asset_if_necessary(int img_idx);
     void prepare_for_drawing(float rect_height);
     void draw_background(QPainter &p, const QRect &rect);
     void draw_entities(QPainter &p, const std::vector<std::shared_ptr<Entity>> &to_draw, int render_z = 0);
+    void find_visible_entities();
+    void draw_visible_entities(QPainter &p, int render_z);
     void draw_image(QPainter &p, QRectF &rect, float rotation, bool is_reflected, int img_idx, int theme, float alpha, float tile_ratio);
 
+    bool supports_level_cache();
+    void restore_level(const CachedLevel &level);
+
+    ContactTracker contact_tracker;
+    std::vector<ContactPair> ended_contacts;
+
+    // the fields of an entity that decide what it blocks in placement_map
+    struct PlacementObstacle {
+        const Entity *ent;
+        float x, y, rx, ry, collision_margin;
+        int type;
+        bool avoids_collisions;
+
+        explicit PlacementObstacle(const Entity &e);
+        bool operator==(const PlacementObstacle &other) const;
+    };
+
+    // free space for the last place_in_free_space call and what it was built for, one obstacle per entity
+    // in order. Invalidated when entities are erased since a new entity could take the place of an erased one.
+    PlacementMap placement_map;
+    bool placement_map_valid = false;
+    std::array<float, 11> placement_key = {};
+    std::vector<PlacementObstacle> placement_obstacles;
+
+    // set by set_collision_policy, sub_step and sweep_step use it directly instead of the virtuals
+    CollisionTable collision_table;
+    bool has_collision_policy = false;
+
+    template <bool use_policy>
+    bool policy_is_blocked(const std::shared_ptr<Entity> &src, int target, bool is_horizontal);
+    template <bool use_policy>
+    bool policy_will_reflect(int src, int target);
     bool sub_step(const std::shared_ptr<Entity> &obj, float _vx, float _vy, int depth);
+    template <bool use_policy>
+    bool sub_step_impl(const std::shared_ptr<Entity> &obj, float _vx, float _vy, int depth);
+    float sweep_step(const std::shared_ptr<Entity> &obj, float delta, bool is_horizontal);
+    template <bool use_policy>
+    float sweep_step_impl(const std::shared_ptr<Entity> &obj, float delta, bool is_horizontal);
+    bool uses_direct_scan();
+    void scan_collision_candidates(float x, float y, float rx, float ry, float margin, int max_idx, std::vector<int> &candidates);
+    void find_collision_candidates(const std::shared_ptr<Entity> &ent, float margin, std::vector<int> &candidates);
+    void find_collision_candidates_at(float x, float y, float rx, float ry, float margin, std::vector<int> &candidates);
+    void find_collision_candidates_below(const std::shared_ptr<Entity> &ent, float margin, int max_idx, std::vector<int> &candidates);
+    void entity_moved(const std::shared_ptr<Entity> &ent);
+    void step_object(const std::shared_ptr<Entity> &obj);
+    bool agent_collides();
+    bool has_any_collision_synced(const std::shared_ptr<Entity> &e1, float margin, bool exclude_self);
     bool should_erase(const std::shared_ptr<Entity> &e1);
+    bool is_reported_contact(const std::shared_ptr<Entity> &src, const std::shared_ptr<Entity> &target);
+    bool place_in_free_space(const std::shared_ptr<Entity> &ent, float x, float y, float w, float h, bool check_collisions);
 };
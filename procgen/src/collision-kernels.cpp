@@ -0,0 +1,184 @@
+#include "collision-kernels.h"
+#include <math.h>
+#include <string.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define PROCGEN_X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define PROCGEN_X86_KERNELS 0
+#endif
+
+static void clear_mask(int n, uint64_t *hits) {
+    memset(hits, 0, sizeof(uint64_t) * ((n + 63) / 64));
+}
+
+static void overlap_mask_scalar(float x, float y, float rx, float ry, float margin, const float *xs, const float *ys, const float *rxs, const float *rys, int begin, int n, uint64_t *hits) {
+    for (int i = begin; i < n; i++) {
+        float threshold_x = (rx + rxs[i]) + margin;
+        float threshold_y = (ry + rys[i]) + margin;
+
+        if ((fabs(x - xs[i]) < threshold_x) && (fabs(y - ys[i]) < threshold_y)) {
+            hits[i / 64] |= (uint64_t)(1) << (i % 64);
+        }
+    }
+}
+
+#if PROCGEN_X86_KERNELS
+
+__attribute__((target("avx2"))) static void overlap_mask_avx2(float x, float y, float rx, float ry, float margin, const float *xs, const float *ys, const float *rxs, const float *rys, int n, uint64_t *hits) {
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 vx = _mm256_set1_ps(x);
+    const __m256 vy = _mm256_set1_ps(y);
+    const __m256 vrx = _mm256_set1_ps(rx);
+    const __m256 vry = _mm256_set1_ps(ry);
+    const __m256 vmargin = _mm256_set1_ps(margin);
+
+    int i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256 dx = _mm256_and_ps(_mm256_sub_ps(vx, _mm256_loadu_ps(xs + i)), abs_mask);
+        __m256 dy = _mm256_and_ps(_mm256_sub_ps(vy, _mm256_loadu_ps(ys + i)), abs_mask);
+        __m256 tx = _mm256_add_ps(_mm256_add_ps(vrx, _mm256_loadu_ps(rxs + i)), vmargin);
+        __m256 ty = _mm256_add_ps(_mm256_add_ps(vry, _mm256_loadu_ps(rys + i)), vmargin);
+        __m256 hit = _mm256_and_ps(_mm256_cmp_ps(dx, tx, _CMP_LT_OQ), _mm256_cmp_ps(dy, ty, _CMP_LT_OQ));
+
+        uint64_t bits = (uint64_t)(_mm256_movemask_ps(hit));
+        hits[i / 64] |= bits << (i % 64);
+    }
+
+    // the last partial group with masked loads, most games have fewer entities than one group
+    if (i < n) {
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        __m256i tail = _mm256_cmpgt_epi32(_mm256_set1_epi32(n - i), lanes);
+        __m256 dx = _mm256_and_ps(_mm256_sub_ps(vx, _mm256_maskload_ps(xs + i, tail)), abs_mask);
+        __m256 dy = _mm256_and_ps(_mm256_sub_ps(vy, _mm256_maskload_ps(ys + i, tail)), abs_mask);
+        __m256 tx = _mm256_add_ps(_mm256_add_ps(vrx, _mm256_maskload_ps(rxs + i, tail)), vmargin);
+        __m256 ty = _mm256_add_ps(_mm256_add_ps(vry, _mm256_maskload_ps(rys + i, tail)), vmargin);
+        __m256 hit = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(dx, tx, _CMP_LT_OQ), _mm256_cmp_ps(dy, ty, _CMP_LT_OQ)), _mm256_castsi256_ps(tail));
+
+        uint64_t bits = (uint64_t)(_mm256_movemask_ps(hit));
+        hits[i / 64] |= bits << (i % 64);
+    }
+}
+
+__attribute__((target("avx512f"))) static void overlap_mask_avx512(float x, float y, float rx, float ry, float margin, const float *xs, const float *ys, const float *rxs, const float *rys, int n, uint64_t *hits) {
+    const __m512 vx = _mm512_set1_ps(x);
+    const __m512 vy = _mm512_set1_ps(y);
+    const __m512 vrx = _mm512_set1_ps(rx);
+    const __m512 vry = _mm512_set1_ps(ry);
+    const __m512 vmargin = _mm512_set1_ps(margin);
+
+    int i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m512 dx = _mm512_abs_ps(_mm512_sub_ps(vx, _mm512_loadu_ps(xs + i)));
+        __m512 dy = _mm512_abs_ps(_mm512_sub_ps(vy, _mm512_loadu_ps(ys + i)));
+        __m512 tx = _mm512_add_ps(_mm512_add_ps(vrx, _mm512_loadu_ps(rxs + i)), vmargin);
+        __m512 ty = _mm512_add_ps(_mm512_add_ps(vry, _mm512_loadu_ps(rys + i)), vmargin);
+        __mmask16 hit = _mm512_mask_cmp_ps_mask(_mm512_cmp_ps_mask(dx, tx, _CMP_LT_OQ), dy, ty, _CMP_LT_OQ);
+
+        hits[i / 64] |= (uint64_t)(hit) << (i % 64);
+    }
+
+    // the last partial group with masked loads, most games have fewer entities than one group
+    if (i < n) {
+        __mmask16 tail = (__mmask16)((1u << (n - i)) - 1);
+        __m512 dx = _mm512_abs_ps(_mm512_sub_ps(vx, _mm512_maskz_loadu_ps(tail, xs + i)));
+        __m512 dy = _mm512_abs_ps(_mm512_sub_ps(vy, _mm512_maskz_loadu_ps(tail, ys + i)));
+        __m512 tx = _mm512_add_ps(_mm512_add_ps(vrx, _mm512_maskz_loadu_ps(tail, rxs + i)), vmargin);
+        __m512 ty = _mm512_add_ps(_mm512_add_ps(vry, _mm512_maskz_loadu_ps(tail, rys + i)), vmargin);
+        __mmask16 hit = _mm512_mask_cmp_ps_mask(_mm512_mask_cmp_ps_mask(tail, dx, tx, _CMP_LT_OQ), dy, ty, _CMP_LT_OQ);
+
+        hits[i / 64] |= (uint64_t)(hit) << (i % 64);
+    }
+}
+
+#endif
+
+enum OverlapImpl {
+    OVERLAP_SCALAR,
+    OVERLAP_AVX2,
+    OVERLAP_AVX512,
+};
+
+static OverlapImpl detected_impl() {
+#if PROCGEN_X86_KERNELS
+    if (__builtin_cpu_supports("avx512f")) {
+        return OVERLAP_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return OVERLAP_AVX2;
+    }
+#endif
+    return OVERLAP_SCALAR;
+}
+
+static bool force_scalar = false;
+
+static OverlapImpl current_impl() {
+    // function local static initialization is thread safe
+    static OverlapImpl impl = detected_impl();
+    return force_scalar ? OVERLAP_SCALAR : impl;
+}
+
+void overlap_mask(float x, float y, float rx, float ry, float margin, const float *xs, const float *ys, const float *rxs, const float *rys, int n, uint64_t *hits) {
+    clear_mask(n, hits);
+
+    switch (current_impl()) {
+#if PROCGEN_X86_KERNELS
+    case OVERLAP_AVX512:
+        overlap_mask_avx512(x, y, rx, ry, margin, xs, ys, rxs, rys, n, hits);
+        return;
+    case OVERLAP_AVX2:
+        overlap_mask_avx2(x, y, rx, ry, margin, xs, ys, rxs, rys, n, hits);
+        return;
+#endif
+    default:
+        overlap_mask_scalar(x, y, rx, ry, margin, xs, ys, rxs, rys, 0, n, hits);
+    }
+}
+
+int overlap_mask_max_entities() {
+    // measured with benchmarks/collision_benchmark.cpp
+    return current_impl() == OVERLAP_SCALAR ? 256 : 2048;
+}
+
+static int highest_bit(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(bits);
+#else
+    int b = 63;
+    while (!(bits >> b)) {
+        b--;
+    }
+    return b;
+#endif
+}
+
+void mask_to_indices_desc(const uint64_t *hits, int n, std::vector<int> &indices) {
+    for (int w = (n + 63) / 64 - 1; w >= 0; w--) {
+        uint64_t bits = hits[w];
+
+        while (bits != 0) {
+            int b = highest_bit(bits);
+            indices.push_back(w * 64 + b);
+            bits &= ~((uint64_t)(1) << b);
+        }
+    }
+}
+
+const char *overlap_mask_impl() {
+    switch (current_impl()) {
+    case OVERLAP_AVX512:
+        return "avx512";
+    case OVERLAP_AVX2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+void set_overlap_mask_scalar(bool scalar) {
+    force_scalar = scalar;
+}
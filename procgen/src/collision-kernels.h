@@ -0,0 +1,30 @@
+#pragma once
+
+/*
+
+Batch versions of BasicAbstractGame::has_collision, testing one rect against many contiguous rects
+
+The AVX2 and AVX-512 versions are selected at runtime when the cpu supports them, so that packaged builds
+(compiled for a baseline cpu) still use them. Results are identical to the scalar version, which is used
+everywhere else.
+
+*/
+
+#include <cstdint>
+#include <vector>
+
+// sets bit i of hits (and clears every other bit) for each i in [0, n) where
+//   fabs(x - xs[i]) < (rx + rxs[i]) + margin && fabs(y - ys[i]) < (ry + rys[i]) + margin
+// hits must have room for (n + 63) / 64 words
+void overlap_mask(float x, float y, float rx, float ry, float margin, const float *xs, const float *ys, const float *rxs, const float *rys, int n, uint64_t *hits);
+
+// entity count up to which a full overlap_mask scan is faster than querying the spatial hash
+int overlap_mask_max_entities();
+
+// appends the indices of the set bits in hits, in descending order
+void mask_to_indices_desc(const uint64_t *hits, int n, std::vector<int> &indices);
+
+// name of the implementation overlap_mask dispatches to on this cpu
+const char *overlap_mask_impl();
+// forces the scalar implementation, for testing and benchmarks
+void set_overlap_mask_scalar(bool scalar);
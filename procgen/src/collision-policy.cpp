@@ -0,0 +1,57 @@
+#include "collision-policy.h"
+#include "cpp-utils.h"
+#include "object-ids.h"
+
+static bool is_table_type(int type) {
+    return type >= 0 && type < COLLISION_TABLE_TYPES;
+}
+
+void CollisionTable::build(CollisionRules blocks, CollisionRules reflects) {
+    rows.clear();
+    rows.emplace_back();
+    src_rows.assign(COLLISION_TABLE_TYPES, 0);
+
+    // every source type gets a copy of the ANY_TYPE row, so rows are built in two passes
+    for (const CollisionRules &rules : {blocks, reflects}) {
+        for (size_t i = 0; i < rules.count; i++) {
+            int src = rules.rules[i].src;
+            fassert(src == ANY_TYPE || is_table_type(src));
+
+            if (src != ANY_TYPE && src_rows[src] == 0) {
+                fassert(rows.size() < 256);
+                src_rows[src] = (uint8_t)(rows.size());
+                rows.emplace_back();
+            }
+        }
+    }
+
+    CollisionRule base_blocks[] = {{ANY_TYPE, WALL_OBJ}, {ANY_TYPE, OUT_OF_BOUNDS_TYPE}};
+    add_rules(CollisionRules(base_blocks), true);
+    add_rules(blocks, true);
+    add_rules(reflects, false);
+}
+
+void CollisionTable::add_rules(CollisionRules rules, bool is_block) {
+    for (size_t i = 0; i < rules.count; i++) {
+        const CollisionRule &rule = rules.rules[i];
+        fassert(rule.target == OUT_OF_BOUNDS_TYPE || is_table_type(rule.target));
+
+        for (size_t r = 0; r < rows.size(); r++) {
+            if (rule.src != ANY_TYPE && src_rows[rule.src] != r) {
+                continue;
+            }
+
+            Row &row = rows[r];
+
+            if (rule.target == OUT_OF_BOUNDS_TYPE) {
+                (is_block ? row.blocks_out_of_bounds : row.reflects_out_of_bounds) = true;
+            } else {
+                (is_block ? row.blocks : row.reflects).set(rule.target);
+            }
+        }
+    }
+}
+
+size_t CollisionTable::memory_bytes() const {
+    return rows.capacity() * sizeof(Row) + src_rows.capacity() * sizeof(uint8_t);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+/*
+
+Static blocking and reflection rules, an alternative to overriding is_blocked and will_reflect
+
+Most games only need rules of the form "objects of type src are blocked by (or reflect off) type target".
+Such games can declare their rules as constexpr arrays and pass them to set_collision_policy, and
+BasicAbstractGame will then move objects with a specialization of sub_step that looks the rules up in
+a dense table instead of calling the virtual functions. Games with rules that depend on game state, or
+that have side effects, keep overriding is_blocked and will_reflect and must not set a policy.
+
+*/
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// matches every source type
+const int ANY_TYPE = -1000;
+// matches the game's out_of_bounds_object, which can change between levels
+const int OUT_OF_BOUNDS_TYPE = -1001;
+
+// types covered by the table, larger source types only match ANY_TYPE rules and larger targets never match
+const int COLLISION_TABLE_TYPES = 1024;
+
+struct CollisionRule {
+    int src;
+    int target;
+};
+
+struct CollisionRules {
+    const CollisionRule *rules = nullptr;
+    size_t count = 0;
+
+    constexpr CollisionRules() {
+    }
+    template <size_t N>
+    constexpr CollisionRules(const CollisionRule (&_rules)[N]) : rules(_rules), count(N) {
+    }
+};
+
+class CollisionTable {
+  public:
+    // blocking always includes WALL_OBJ and out_of_bounds_object for every source type, like
+    // BasicAbstractGame::is_blocked
+    void build(CollisionRules blocks, CollisionRules reflects);
+
+    bool blocks(int src, int target, int out_of_bounds_object) const {
+        const Row &row = rows[row_for(src)];
+        if (target == out_of_bounds_object && row.blocks_out_of_bounds)
+            return true;
+        return target >= 0 && target < COLLISION_TABLE_TYPES && row.blocks.test(target);
+    }
+
+    bool reflects(int src, int target, int out_of_bounds_object) const {
+        const Row &row = rows[row_for(src)];
+        if (target == out_of_bounds_object && row.reflects_out_of_bounds)
+            return true;
+        return target >= 0 && target < COLLISION_TABLE_TYPES && row.reflects.test(target);
+    }
+
+    size_t memory_bytes() const;
+
+  private:
+    struct Row {
+        std::bitset<COLLISION_TABLE_TYPES> blocks;
+        std::bitset<COLLISION_TABLE_TYPES> reflects;
+        bool blocks_out_of_bounds = false;
+        bool reflects_out_of_bounds = false;
+    };
+
+    // row 0 holds the ANY_TYPE rules, every source type named in a rule gets its own row
+    std::vector<Row> rows;
+    std::vector<uint8_t> src_rows;
+
+    int row_for(int src) const {
+        return (src >= 0 && src < COLLISION_TABLE_TYPES) ? src_rows[src] : 0;
+    }
+    void add_rules(CollisionRules rules, bool is_block);
+};
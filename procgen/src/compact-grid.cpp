@@ -0,0 +1,177 @@
+#include "compact-grid.h"
+#include "cpp-utils.h"
+#include <algorithm>
+
+static int popcount(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(bits);
+#else
+    int count = 0;
+    while (bits != 0) {
+        bits &= bits - 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+static int lowest_bit(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(bits);
+#else
+    int b = 0;
+    while (!((bits >> b) & 1)) {
+        b++;
+    }
+    return b;
+#endif
+}
+
+// bits lo through hi (inclusive) of a word
+static uint64_t bit_range(int lo, int hi) {
+    uint64_t upper = hi == 63 ? ~(uint64_t)(0) : (((uint64_t)(1) << (hi + 1)) - 1);
+    return upper & ~(((uint64_t)(1) << lo) - 1);
+}
+
+void CompactGrid::resize(int width, int height) {
+    w = width;
+    h = height;
+    words_per_row = (w + 63) / 64;
+
+    cells.assign(w * h, 0);
+    palette.clear();
+    layers.clear();
+    add_code(0);
+
+    std::vector<uint64_t> &all = layers[0];
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x += 64) {
+            all[y * words_per_row + x / 64] = bit_range(0, std::min(63, w - 1 - x));
+        }
+    }
+}
+
+int CompactGrid::code_for(int type) const {
+    for (int code = 0; code < (int)(palette.size()); code++) {
+        if (palette[code] == type) {
+            return code;
+        }
+    }
+
+    return -1;
+}
+
+int CompactGrid::add_code(int type) {
+    fassert(palette.size() < 256);
+    palette.push_back(type);
+    layers.emplace_back(words_per_row * h, 0);
+    return (int)(palette.size()) - 1;
+}
+
+void CompactGrid::set_index(int idx, int type) {
+    int old_code = cells[idx];
+    if (palette[old_code] == type) {
+        return;
+    }
+
+    int code = code_for(type);
+    if (code < 0) {
+        code = add_code(type);
+    }
+
+    int x = idx % w;
+    int word = (idx / w) * words_per_row + x / 64;
+    uint64_t bit = (uint64_t)(1) << (x % 64);
+
+    layers[old_code][word] &= ~bit;
+    layers[code][word] |= bit;
+    cells[idx] = (uint8_t)(code);
+}
+
+void CompactGrid::fill_rect(int x, int y, int dx, int dy, int type) {
+    if (dx <= 0 || dy <= 0) {
+        return;
+    }
+
+    int code = code_for(type);
+    if (code < 0) {
+        code = add_code(type);
+    }
+
+    int num_codes = (int)(palette.size());
+
+    for (int row = y; row < y + dy; row++) {
+        std::fill(cells.begin() + row * w + x, cells.begin() + row * w + x + dx, (uint8_t)(code));
+
+        for (int k = x / 64; k <= (x + dx - 1) / 64; k++) {
+            int lo = k == x / 64 ? x % 64 : 0;
+            int hi = k == (x + dx - 1) / 64 ? (x + dx - 1) % 64 : 63;
+            uint64_t mask = bit_range(lo, hi);
+            int word = row * words_per_row + k;
+
+            for (int c = 0; c < num_codes; c++) {
+                layers[c][word] &= ~mask;
+            }
+            layers[code][word] |= mask;
+        }
+    }
+}
+
+void CompactGrid::cells_with_type(int type, std::vector<int> &out) const {
+    int code = code_for(type);
+    if (code < 0) {
+        return;
+    }
+
+    const std::vector<uint64_t> &layer = layers[code];
+
+    for (int y = 0; y < h; y++) {
+        for (int k = 0; k < words_per_row; k++) {
+            uint64_t bits = layer[y * words_per_row + k];
+
+            while (bits != 0) {
+                int b = lowest_bit(bits);
+                out.push_back(y * w + k * 64 + b);
+                bits &= bits - 1;
+            }
+        }
+    }
+}
+
+int CompactGrid::count_in_rect(int type, int x0, int y0, int x1, int y1) const {
+    int code = code_for(type);
+    if (code < 0) {
+        return 0;
+    }
+
+    const std::vector<uint64_t> &layer = layers[code];
+    int count = 0;
+
+    for (int y = y0; y <= y1; y++) {
+        for (int k = x0 / 64; k <= x1 / 64; k++) {
+            int lo = k == x0 / 64 ? x0 % 64 : 0;
+            int hi = k == x1 / 64 ? x1 % 64 : 63;
+            count += popcount(layer[y * words_per_row + k] & bit_range(lo, hi));
+        }
+    }
+
+    return count;
+}
+
+void CompactGrid::type_rows(int type, std::vector<uint64_t> &rows) const {
+    int code = code_for(type);
+    if (code < 0) {
+        rows.assign(words_per_row * h, 0);
+        return;
+    }
+
+    rows = layers[code];
+}
+
+size_t CompactGrid::memory_bytes() const {
+    size_t bytes = cells.capacity() * sizeof(uint8_t) + palette.capacity() * sizeof(int);
+    for (const auto &layer : layers) {
+        bytes += sizeof(layer) + layer.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+/*
+
+Grid of object types stored as one byte per cell, with an occupancy bitset per type
+
+Cells hold an index into a palette of the types that have been written to the grid since the last resize,
+so a grid can hold at most 256 distinct types. Every palette entry has a bitset with one bit per cell,
+padded to whole 64 bit words per row, which answers "which cells have type X" a word at a time.
+
+Unlike Grid, get and set do not check bounds, callers (the BasicAbstractGame grid accessors) are expected
+to do that once at the API edge.
+
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class CompactGrid {
+  public:
+    int w = 0;
+    int h = 0;
+
+    // every cell is set to type 0, like Grid<int>
+    void resize(int width, int height);
+
+    bool contains(int x, int y) const {
+        return 0 <= y && y < h && 0 <= x && x < w;
+    }
+
+    bool contains_index(int idx) const {
+        return 0 <= idx && idx < w * h;
+    }
+
+    int to_index(int x, int y) const {
+        return y * w + x;
+    }
+
+    void to_xy(int idx, int *x, int *y) const {
+        *x = idx % w;
+        *y = idx / w;
+    }
+
+    int get(int x, int y) const {
+        return palette[cells[y * w + x]];
+    }
+
+    int get_index(int idx) const {
+        return palette[cells[idx]];
+    }
+
+    void set(int x, int y, int type) {
+        set_index(y * w + x, type);
+    }
+
+    void set_index(int idx, int type);
+    // sets every cell of the rect [x, x + dx) x [y, y + dy), a row span and bitset word at a time
+    void fill_rect(int x, int y, int dx, int dy, int type);
+
+    // appends the indices of all cells with the given type, in increasing order
+    void cells_with_type(int type, std::vector<int> &cells) const;
+    // number of cells with the given type in the rect [x0, x1] x [y0, y1], which must be inside the grid
+    int count_in_rect(int type, int x0, int y0, int x1, int y1) const;
+    // copies the bitset of the given type, row_words() words per row with cell x in bit x % 64 of word x / 64
+    void type_rows(int type, std::vector<uint64_t> &rows) const;
+
+    int row_words() const {
+        return words_per_row;
+    }
+
+    size_t memory_bytes() const;
+
+  private:
+    std::vector<uint8_t> cells;
+    std::vector<int> palette;
+    // one bitset per palette entry, words_per_row words for each row
+    std::vector<std::vector<uint64_t>> layers;
+    int words_per_row = 0;
+
+    int code_for(int type) const;
+    int add_code(int type);
+};
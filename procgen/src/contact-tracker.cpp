@@ -0,0 +1,43 @@
+#include "contact-tracker.h"
+#include <algorithm>
+#include <iterator>
+
+static bool contact_less(const ContactPair &a, const ContactPair &b) {
+    if (a.src.slot != b.src.slot)
+        return a.src.slot < b.src.slot;
+    if (a.src.generation != b.src.generation)
+        return a.src.generation < b.src.generation;
+    if (a.target.slot != b.target.slot)
+        return a.target.slot < b.target.slot;
+    return a.target.generation < b.target.generation;
+}
+
+void ContactTracker::clear() {
+    previous.clear();
+    current.clear();
+}
+
+bool ContactTracker::add(EntityHandle src, EntityHandle target) {
+    ContactPair pair = {src, target};
+    current.push_back(pair);
+
+    return !std::binary_search(previous.begin(), previous.end(), pair, contact_less);
+}
+
+void ContactTracker::end_step(std::vector<ContactPair> &ended) {
+    std::sort(current.begin(), current.end(), contact_less);
+    current.erase(std::unique(current.begin(), current.end(), [](const ContactPair &a, const ContactPair &b) {
+                      return a.src == b.src && a.target == b.target;
+                  }),
+                  current.end());
+
+    ended.clear();
+    std::set_difference(previous.begin(), previous.end(), current.begin(), current.end(), std::back_inserter(ended), contact_less);
+
+    previous.swap(current);
+    current.clear();
+}
+
+size_t ContactTracker::memory_bytes() const {
+    return (previous.capacity() + current.capacity()) * sizeof(ContactPair);
+}
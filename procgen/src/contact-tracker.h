@@ -0,0 +1,43 @@
+#pragma once
+
+/*
+
+Contacts between entities that persist across steps
+
+BasicAbstractGame reports a contact every step two entities overlap. ContactTracker keeps the contacts of
+the previous step as a sorted flat list of handle pairs, so each contact found during a step can be
+classified as beginning or staying with a binary search, and contacts that were not found again are
+reported as ended once the step is over.
+
+*/
+
+#include <cstddef>
+#include <vector>
+#include "entity.h"
+
+struct ContactPair {
+    EntityHandle src;
+    EntityHandle target;
+};
+
+class ContactTracker {
+  public:
+    void clear();
+
+    // records a contact for the current step, returns true if it did not exist in the previous step
+    bool add(EntityHandle src, EntityHandle target);
+
+    // finishes the current step, ended is set to the contacts of the previous step that were not added again
+    void end_step(std::vector<ContactPair> &ended);
+
+    // contacts added during the current step, in the order they were added
+    const std::vector<ContactPair> &get_current() const {
+        return current;
+    }
+
+    size_t memory_bytes() const;
+
+  private:
+    std::vector<ContactPair> previous;
+    std::vector<ContactPair> current;
+};
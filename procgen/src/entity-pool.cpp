@@ -0,0 +1,44 @@
+#include "entity-pool.h"
+#include <new>
+
+EntityPool::EntityPool() {
+}
+
+EntityPool::~EntityPool() {
+    for (void *block : free_blocks) {
+        ::operator delete(block);
+    }
+}
+
+void *EntityPool::allocate(size_t bytes) {
+    if (block_bytes == 0) {
+        block_bytes = bytes;
+    }
+
+    if (bytes != block_bytes) {
+        return ::operator new(bytes);
+    }
+
+    if (free_blocks.empty()) {
+        num_blocks++;
+        return ::operator new(bytes);
+    }
+
+    void *block = free_blocks.back();
+    free_blocks.pop_back();
+
+    return block;
+}
+
+void EntityPool::deallocate(void *block, size_t bytes) {
+    if (bytes != block_bytes) {
+        ::operator delete(block);
+        return;
+    }
+
+    free_blocks.push_back(block);
+}
+
+size_t EntityPool::memory_bytes() const {
+    return num_blocks * block_bytes + free_blocks.capacity() * sizeof(void *);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+/*
+
+Free list of entity allocations, so that games which spawn and erase entities every step (bullets,
+trails, exhaust) reuse memory instead of going to the heap each time
+
+Entities are still handed out as std::shared_ptr, allocate_shared places the control block and the
+Entity in a single pooled block. Every allocator copy holds a reference to the pool, so the pool
+outlives any entity allocated from it.
+
+*/
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class EntityPool {
+  public:
+    EntityPool();
+    ~EntityPool();
+    EntityPool(const EntityPool &) = delete;
+    EntityPool &operator=(const EntityPool &) = delete;
+
+    void *allocate(size_t bytes);
+    void deallocate(void *block, size_t bytes);
+
+    size_t memory_bytes() const;
+
+  private:
+    // only one block size is pooled, allocate_shared<Entity> always asks for the same size
+    size_t block_bytes = 0;
+    size_t num_blocks = 0;
+    std::vector<void *> free_blocks;
+};
+
+template <typename T>
+class EntityPoolAllocator {
+  public:
+    typedef T value_type;
+
+    std::shared_ptr<EntityPool> pool;
+
+    explicit EntityPoolAllocator(const std::shared_ptr<EntityPool> &_pool) : pool(_pool) {
+    }
+    template <typename U>
+    EntityPoolAllocator(const EntityPoolAllocator<U> &other) : pool(other.pool) {
+    }
+
+    T *allocate(size_t n) {
+        return static_cast<T *>(pool->allocate(n * sizeof(T)));
+    }
+    void deallocate(T *p, size_t n) {
+        pool->deallocate(p, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const EntityPoolAllocator<U> &other) const {
+        return pool == other.pool;
+    }
+    template <typename U>
+    bool operator!=(const EntityPoolAllocator<U> &other) const {
+        return pool != other.pool;
+    }
+};
@@ -0,0 +1,127 @@
+#include "entity-store.h"
+#include "cpp-utils.h"
+
+void EntityStore::clear() {
+    for (auto &slot : slots) {
+        if (slot.ent != nullptr) {
+            auto ent = slot.ent;
+            release(ent);
+        }
+    }
+
+    x.clear();
+    y.clear();
+    rx.clear();
+    ry.clear();
+    handles.clear();
+    max_collision_margin = 0;
+}
+
+void EntityStore::sync(const std::vector<std::shared_ptr<Entity>> &entities) {
+    size_t n = entities.size();
+
+    x.resize(n);
+    y.resize(n);
+    rx.resize(n);
+    ry.resize(n);
+    handles.resize(n);
+    max_collision_margin = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        const auto &ent = entities[i];
+
+        handles[i] = get_handle(ent);
+        slot_rows[handles[i].slot] = (int)(i);
+        update((int)(i), *ent);
+    }
+}
+
+void EntityStore::update(int i, const Entity &ent) {
+    x[i] = ent.x;
+    y[i] = ent.y;
+    rx[i] = ent.rx;
+    ry[i] = ent.ry;
+
+    if (ent.collision_margin > max_collision_margin) {
+        max_collision_margin = ent.collision_margin;
+    }
+}
+
+int EntityStore::index_of(EntityHandle handle) const {
+    if (handle.slot < 0 || handle.slot >= (int)(slot_rows.size())) {
+        return -1;
+    }
+
+    int row = slot_rows[handle.slot];
+    if (row < 0 || row >= size() || handles[row] != handle) {
+        return -1;
+    }
+
+    return row;
+}
+
+int EntityStore::size() const {
+    return (int)(handles.size());
+}
+
+EntityHandle EntityStore::get_handle(const std::shared_ptr<Entity> &ent) {
+    if (ent->handle.slot >= 0) {
+        return ent->handle;
+    }
+
+    int slot_idx;
+
+    if (free_slots.empty()) {
+        slot_idx = (int)(slots.size());
+        slots.emplace_back();
+        slot_rows.push_back(-1);
+    } else {
+        slot_idx = free_slots.back();
+        free_slots.pop_back();
+    }
+
+    Slot &slot = slots[slot_idx];
+    slot.ent = ent;
+    ent->handle.slot = slot_idx;
+    ent->handle.generation = slot.generation;
+
+    return ent->handle;
+}
+
+std::shared_ptr<Entity> EntityStore::get(EntityHandle handle) const {
+    if (handle.slot < 0 || handle.slot >= (int)(slots.size())) {
+        return nullptr;
+    }
+
+    const Slot &slot = slots[handle.slot];
+
+    if (slot.generation != handle.generation) {
+        return nullptr;
+    }
+
+    return slot.ent;
+}
+
+void EntityStore::release(const std::shared_ptr<Entity> &ent) {
+    EntityHandle handle = ent->handle;
+
+    if (handle.slot < 0) {
+        return;
+    }
+
+    Slot &slot = slots[handle.slot];
+    fassert(slot.ent == ent && slot.generation == handle.generation);
+
+    ent->handle = EntityHandle();
+    slot.ent = nullptr;
+    slot.generation++;
+    free_slots.push_back(handle.slot);
+}
+
+size_t EntityStore::memory_bytes() const {
+    size_t bytes = (x.capacity() + y.capacity() + rx.capacity() + ry.capacity()) * sizeof(float);
+    bytes += handles.capacity() * sizeof(EntityHandle);
+    bytes += slots.capacity() * sizeof(Slot) + (free_slots.capacity() + slot_rows.capacity()) * sizeof(int);
+
+    return bytes;
+}
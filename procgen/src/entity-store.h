@@ -0,0 +1,55 @@
+#pragma once
+
+/*
+
+Collision-query mirror of a game's entities, plus the slot table behind EntityHandle
+
+The store does not own any entity state. Entity objects remain authoritative, since games read and write
+their fields directly and Entity::step() is virtual. sync() copies the positions and half-sizes of the
+entities into contiguous arrays, indexed like the entities vector, for the overlap kernels and the spatial
+hash to find collision candidates, and update() refreshes the row of one entity after the engine moves it.
+The candidates are then tested against the Entity objects. Games with few entities never sync the store,
+only its handles are used, see BasicAbstractGame::uses_direct_scan.
+
+*/
+
+#include <memory>
+#include <vector>
+#include "entity.h"
+
+class EntityStore {
+  public:
+    // fields of entities[i] as of the last sync
+    std::vector<float> x, y, rx, ry;
+    std::vector<EntityHandle> handles;
+    // upper bound of the collision margins of the synced entities
+    float max_collision_margin = 0;
+
+    void clear();
+    void sync(const std::vector<std::shared_ptr<Entity>> &entities);
+    // refreshes row i from ent, which must be the entity synced into it. max_collision_margin is only ever
+    // raised here, which keeps it an upper bound.
+    void update(int i, const Entity &ent);
+    // row of the entity with this handle as of the last sync, -1 if it was not synced
+    int index_of(EntityHandle handle) const;
+
+    int size() const;
+
+    EntityHandle get_handle(const std::shared_ptr<Entity> &ent);
+    // nullptr if the entity has been released
+    std::shared_ptr<Entity> get(EntityHandle handle) const;
+    void release(const std::shared_ptr<Entity> &ent);
+
+    size_t memory_bytes() const;
+
+  private:
+    struct Slot {
+        std::shared_ptr<Entity> ent;
+        uint32_t generation = 1;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<int> free_slots;
+    // row of the entity in each slot, as of the last sync
+    std::vector<int> slot_rows;
+};
@@ -1,8 +1,22 @@
 #pragma once
 
 #include "object-ids.h"
+#include <cstdint>
 #include <memory>
 
+// refers to an entity without owning it, resolves to nothing once the entity has been erased
+struct EntityHandle {
+    int slot = -1;
+    uint32_t generation = 0;
+
+    bool operator==(const EntityHandle &other) const {
+        return slot == other.slot && generation == other.generation;
+    }
+    bool operator!=(const EntityHandle &other) const {
+        return !(*this == other);
+    }
+};
+
 class Entity {
   public:
     float x, y, vx, vy, rx, ry;
@@ -34,7 +48,10 @@ class Entity {
     float grow_rate;
     float alpha_decay;
     float climber_spawn_x;
-    std::weak_ptr<Entity> relative;
+    EntityHandle relative;
+
+    // assigned by the EntityStore of the game that owns this entity
+    EntityHandle handle;
 
     Entity(float _x, float _y, float _dx, float _dy, float _rx, float _ry, int _type);
     Entity(float _x, float _y, float _dx, float _dy, float _r, int _type);
@@ -19,7 +19,9 @@ class Game;
 
 #define REGISTER_GAME(name, cls)                                         \
     static auto UNUSED_FUNCTION(_registration) = registerGame(name, [] { \
-        return std::make_shared<cls>();                                  \
+        auto game = std::make_shared<cls>();                             \
+        game->instance_bytes = sizeof(cls);                              \
+        return game;                                                     \
     })
 
 extern std::map<std::string, std::function<std::shared_ptr<Game>()>> *globalGameRegistry;
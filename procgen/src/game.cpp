@@ -1,6 +1,17 @@
 
 #include "game.h"
 #include "vecoptions.h"
+#include "level-cache.h"
+#include "level-pack.h"
+#include "level-sampler.h"
+#include "level-sweep.h"
+#include "levelgen-profile.h"
+#include <algorithm>
+#include <cstring>
+
+// Observations are rendered into this scratch buffer and then converted into the obs buffer,
+// it only needs to exist once per stepping thread rather than once per env
+static thread_local uint32_t render_buf[RES_W * RES_H];
 
 void bgr32_to_rgb888(void *dst_rgb888, void *src_bgr32, int w, int h) {
     uint8_t *src = (uint8_t *)src_bgr32;
@@ -19,6 +30,41 @@ void bgr32_to_rgb888(void *dst_rgb888, void *src_bgr32, int w, int h) {
     }
 }
 
+void MemoryUsage::add_env(const std::string &category, size_t bytes) {
+    env_bytes[category] += bytes;
+}
+
+void MemoryUsage::add_shared(const std::string &category, const void *owner, size_t bytes) {
+    shared_bytes[category][owner] = bytes;
+}
+
+size_t GameOptions::memory_bytes() {
+    size_t bytes = 0;
+
+    for (const auto &opt : opts) {
+        // map node, option object and its value array, all approximate
+        bytes += sizeof(opt) + 4 * sizeof(void *);
+        bytes += opt.first.capacity();
+        bytes += sizeof(GameOption<int32_t>) + sizeof(int32_t);
+    }
+
+    return bytes;
+}
+
+bool supports_distribution_mode(const std::string &name, DistributionMode mode) {
+    if (mode == EasyMode) {
+        return name != "coinrun_old";
+    } else if (mode == HardMode) {
+        // all environments support this mode
+        return true;
+    } else if (mode == ExtremeMode) {
+        return name == "chaser" || name == "dodgeball" || name == "leaper" || name == "starpilot";
+    } else if (mode == MemoryMode) {
+        return name == "collector" || name == "caveflyer" || name == "dodgeball" || name == "heist" || name == "jumper" || name == "maze" || name == "miner";
+    }
+    return false;
+}
+
 Game::Game() {
     timeout = 1000;
     episodes_remaining = 0;
@@ -28,6 +74,7 @@ Game::Game() {
     fixed_asset_seed = 0;
     reset_count = 0;
     current_level_seed = 0;
+    std::fill(level_stats, level_stats + NUM_LEVEL_STATS, -1);
 
     step_data.reward = 0;
     step_data.done = false;
@@ -35,6 +82,7 @@ Game::Game() {
 
     register_info_buffer("level_seed");
     register_info_buffer("level_complete");
+    register_info_buffer("level_stats");
     register_obs_buffer("rgb");
 
 }
@@ -43,27 +91,31 @@ Game::~Game() {
 }
 
 void Game::parse_options(std::string name, VecOptions opts) {
+    game_name = name;
+
     opts.consume_bool("use_easy_jump", &options.use_easy_jump);
     opts.consume_bool("paint_vel_info", &options.paint_vel_info);
     opts.consume_bool("use_generated_assets", &options.use_generated_assets);
     opts.consume_bool("center_agent", &options.center_agent);
     opts.consume_bool("use_sequential_levels", &options.use_sequential_levels);
+    opts.consume_bool("use_fast_level_generation", &options.use_fast_level_generation);
+    rand_gen.stream_compatible = !options.use_fast_level_generation;
+    opts.consume_bool("use_continuous_collision", &options.use_continuous_collision);
+    opts.consume_int("level_cache_mb", &options.level_cache_mb);
+    fassert(options.level_cache_mb >= 0);
+    if (options.level_cache_mb > 0) {
+        LevelCache::shared().reserve((size_t)(options.level_cache_mb) << 20);
+    }
+    opts.consume_string("level_pack", &options.level_pack);
 
     int dist_mode = EasyMode;
     opts.consume_int("distribution_mode", &dist_mode);
     options.distribution_mode = static_cast<DistributionMode>(dist_mode);
 
-    if (options.distribution_mode == EasyMode) {
-        fassert(name != "coinrun_old");
-    } else if (options.distribution_mode == HardMode) {
-        // all environments support this mode
-    } else if (options.distribution_mode == ExtremeMode) {
-        fassert(name == "chaser" || name == "dodgeball" || name == "leaper" || name == "starpilot");
-    } else if (options.distribution_mode == MemoryMode) {
-        fassert(name == "collector" || name == "caveflyer" || name == "dodgeball" || name == "heist" || name == "jumper" || name == "maze" || name == "miner");
-    } else {
+    if (options.distribution_mode != EasyMode && options.distribution_mode != HardMode && options.distribution_mode != ExtremeMode && options.distribution_mode != MemoryMode) {
         fatal("invalid distribution_mode %d\n", options.distribution_mode);
     }
+    fassert(supports_distribution_mode(name, options.distribution_mode));
 
     // coinrun_old
     opts.consume_int("plain_assets", &options.plain_assets);
@@ -89,6 +141,55 @@ void Game::parse_options(std::string name, VecOptions opts) {
     }
 
     opts.ensure_empty();
+
+    level_options_hash = hash_level_options();
+
+    if (!options.level_pack.empty()) {
+        level_pack = LevelPack::open(options.level_pack);
+        if (level_pack->header().options_hash != level_options_hash || game_name != level_pack->header().env_name) {
+            fatal("level pack %s was generated for %s with different options\n", options.level_pack.c_str(), level_pack->header().env_name);
+        }
+    }
+}
+
+// FNV-1a over the game name and every option, except the ones that only change rendering or stepping
+uint64_t Game::hash_level_options() {
+    uint64_t hash = 14695981039346656037ULL;
+    auto add = [&hash](const void *data, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ ((const uint8_t *)(data))[i]) * 1099511628211ULL;
+        }
+    };
+    auto add_int = [&add](int value) {
+        add(&value, sizeof(value));
+    };
+
+    add(game_name.data(), game_name.size());
+    add_int(game_type);
+    add_int(rand_gen.get_backend());
+    add_int(options.distribution_mode);
+    add_int(options.use_generated_assets);
+    add_int(options.center_agent);
+    add_int(options.use_fast_level_generation);
+    add_int(options.use_easy_jump);
+    add_int(options.plain_assets);
+    add_int(options.physics_mode);
+    add_int(options.debug_mode);
+
+    for (const auto &kv : options.opts) {
+        add(kv.first.data(), kv.first.size());
+        add_int(kv.second->dtype);
+        if (kv.second->dtype == LIBENV_DTYPE_FLOAT32) {
+            float value = options.get<float>(kv.first);
+            add(&value, sizeof(value));
+        } else if (kv.second->dtype == LIBENV_DTYPE_INT32) {
+            add_int(options.get<int32_t>(kv.first));
+        } else {
+            add_int(options.get<uint8_t>(kv.first));
+        }
+    }
+
+    return hash;
 }
 
 void Game::render_to_buf(void *dst, int w, int h, bool antialias) {
@@ -105,6 +206,17 @@ void Game::render_to_buf(void *dst, int w, int h, bool antialias) {
 
     QRect rect = QRect(0, 0, w, h);
     game_draw(p, rect);
+
+#ifdef PROCGEN_HEADLESS
+    // painting is a no-op without Qt, but drawing still runs since some games update state while drawing
+    memset(dst, 0, w * h * 4);
+#endif
+}
+
+void Game::memory_usage(MemoryUsage &usage) {
+    usage.add_env("game", instance_bytes - 2 * sizeof(RandGen));
+    usage.add_env("rand_gen", level_seed_rand_gen.memory_bytes() + rand_gen.memory_bytes());
+    usage.add_env("options", options.memory_bytes());
 }
 
 int Game::get_num_episodes_done(){
@@ -114,10 +226,23 @@ int Game::get_num_episodes_done(){
 void Game::reset() {
     reset_count++;
 
+    is_sweep_episode = false;
+
     if (episodes_remaining == 0) {
         if (options.use_sequential_levels && step_data.level_complete) {
             // prevent overflow in seed sequences
             current_level_seed = (int32_t)(current_level_seed + 997);
+        } else if (level_sweep) {
+            int level_seed = level_sweep->claim();
+            if (level_seed >= 0) {
+                current_level_seed = level_seed;
+                is_sweep_episode = true;
+            } else {
+                // the level is replayed so the env is left in a valid state, but it is not stepped again
+                sweep_finished = true;
+            }
+        } else if (level_sampler) {
+            current_level_seed = level_sampler->sample_for_env(level_seed_rand_gen, game_n);
         } else {
             current_level_seed = level_seed_rand_gen.randint(level_seed_low, level_seed_high);
         }
@@ -130,7 +255,15 @@ void Game::reset() {
     }
 
     rand_gen.seed(current_level_seed);
-    game_reset();
+
+    if (!load_cached_level()) {
+        std::fill(level_stats, level_stats + NUM_LEVEL_STATS, -1);
+        {
+            PROFILE_LEVELGEN_PHASE(LEVELGEN_GENERATOR);
+            game_reset();
+        }
+        save_cached_level();
+    }
 
     auto ptr = point_to_obs<uint8_t>("rgb");
     if (ptr != 0){
@@ -158,6 +291,44 @@ void Game::step() {
     step_data.level_complete = false;
     game_step();
 
+    int level_seed = current_level_seed;
+    // like level_seed, report the level this step was taken in rather than the one a reset moves to
+    auto stats_ptr = point_to_info<int32_t>("level_stats");
+    if (stats_ptr != 0) {
+        memcpy(stats_ptr, level_stats, sizeof(level_stats));
+    }
+    end_step(will_force_reset);
+
+    auto ptr = point_to_obs<uint8_t>("rgb");
+    if (ptr != 0){
+      render_to_buf(render_buf, RES_W, RES_H, false);
+      bgr32_to_rgb888(ptr, render_buf, RES_W, RES_H);
+    }
+
+    *reward_ptr = step_data.reward;
+    *done_ptr = (uint8_t)step_data.done;
+    assign_to_info("level_seed",(int32_t)(level_seed));
+    assign_to_info("level_complete",(uint8_t)(step_data.level_complete));
+}
+
+void Game::reset_to_level(int level_seed) {
+    fassert(level_seed >= 0);
+    // the claimed level would never be recorded, so another reset of the sweep plays it
+    if (is_sweep_episode) {
+        level_sweep->release(current_level_seed);
+    }
+    // the env is stepped again to play this level, and finishes at the next reset if the sweep is over
+    sweep_finished = false;
+    current_level_seed = level_seed;
+    // reset keeps current_level_seed when an episode of the level remains
+    episodes_remaining = 1;
+    reset();
+}
+
+/*
+  Episode bookkeeping once step_data has been filled in for a step, resets the game when the episode is over
+*/
+void Game::end_step(bool will_force_reset) {
     step_data.done = step_data.done || will_force_reset || (cur_time >= timeout);
     total_reward += step_data.reward;
 
@@ -166,10 +337,11 @@ void Game::step() {
         last_reward = step_data.reward;
     }
 
-    int level_seed = current_level_seed;
-
     if (step_data.done) {
         last_ep_reward = total_reward;
+        if (is_sweep_episode) {
+            level_sweep->record(current_level_seed, total_reward, cur_time, step_data.level_complete);
+        }
         reset();
     }
 
@@ -181,20 +353,28 @@ void Game::step() {
     if (step_data.done){
       num_episodes_done++;
     }
+}
 
-    auto ptr = point_to_obs<uint8_t>("rgb");
-    if (ptr != 0){
-      render_to_buf(render_buf, RES_W, RES_H, false);
-      bgr32_to_rgb888(ptr, render_buf, RES_W, RES_H);
-    }
+void Game::game_init() {
+}
 
-    *reward_ptr = step_data.reward;
-    *done_ptr = (uint8_t)step_data.done;
-    assign_to_info("level_seed",(int32_t)(level_seed));
-    assign_to_info("level_complete",(uint8_t)(step_data.level_complete));
+bool Game::load_cached_level() {
+    return false;
 }
 
-void Game::game_init() {
+void Game::save_cached_level() {
+}
+
+bool Game::capture_level(CachedLevel *level) {
+    return false;
+}
+
+bool Game::generate_level(int level_seed, CachedLevel *level) {
+    current_level_seed = level_seed;
+    rand_gen.seed(level_seed);
+    std::fill(level_stats, level_stats + NUM_LEVEL_STATS, -1);
+    game_reset();
+    return capture_level(level);
 }
 
 void Game::register_info_buffer(std::string name){
@@ -6,11 +6,17 @@ Base class used for all games, all games must inherit from this
 
 */
 
+#ifdef PROCGEN_HEADLESS
+#include "qt-headless.h"
+#else
 #include <QtGui/QPainter>
+#endif
 #include <memory>
 #include <functional>
 #include <vector>
 #include <variant>
+#include <map>
+#include <mutex>
 
 #include "libenv.h"
 
@@ -19,6 +25,7 @@ Base class used for all games, all games must inherit from this
 #include "resources.h"
 #include "object-ids.h"
 #include "game-registry.h"
+#include "level-stats.h"
 
 // We want all games to have same observation space. So all these
 // constants here related to observation space are constants forever.
@@ -30,6 +37,10 @@ const int RENDER_RES = 512;
 void bgr32_to_rgb888(void *dst_rgb888, void *src_bgr32, int w, int h);
 
 class VecOptions;
+struct CachedLevel;
+class LevelPack;
+class LevelSampler;
+class LevelSweep;
 
 enum DistributionMode {
     EasyMode = 0,
@@ -38,6 +49,41 @@ enum DistributionMode {
     MemoryMode = 10,
 };
 
+// whether the game registered as name can generate levels in mode
+bool supports_distribution_mode(const std::string &name, DistributionMode mode);
+
+/*
+  Byte counts used to size large batches of environments. Allocations owned by a single
+  env are summed per category. Allocations shared between envs are keyed by their owner,
+  so they are only counted once no matter how many envs reference them.
+*/
+struct MemoryUsage {
+    std::map<std::string, size_t> env_bytes;
+    std::map<std::string, std::map<const void *, size_t>> shared_bytes;
+
+    void add_env(const std::string &category, size_t bytes);
+    void add_shared(const std::string &category, const void *owner, size_t bytes);
+};
+
+/*
+  Returns the object shared by all games constructed with the same key, creating it on first use.
+  Use this for data that only depends on the game type and its options, such as asset tables,
+  so that it is not duplicated in every env. The object is freed once no game references it.
+*/
+template <typename T>
+std::shared_ptr<T> get_shared_game_data(const std::string &key) {
+    static std::mutex registry_mutex;
+    static std::map<std::string, std::weak_ptr<T>> registry;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto shared = registry[key].lock();
+    if (shared == nullptr) {
+        shared = std::make_shared<T>();
+        registry[key] = shared;
+    }
+    return shared;
+}
+
 struct StepData {
     float reward = 0.0f;
     bool done = false;
@@ -96,6 +142,12 @@ struct GameOptions {
     int debug_mode = 0;
     DistributionMode distribution_mode = HardMode;
     bool use_sequential_levels = false;
+    bool use_fast_level_generation = false;
+    bool use_continuous_collision = false;
+    // size of the process-wide LevelCache, 0 disables it
+    int level_cache_mb = 0;
+    // path of a LevelPack to read levels from, empty disables it
+    std::string level_pack;
 
     // coinrun_old
     bool use_easy_jump = false;
@@ -151,6 +203,8 @@ struct GameOptions {
       return std::static_pointer_cast<GameOption<T>>(gopt_it->second)->get();
     }
 
+    size_t memory_bytes();
+
     template<typename T>
     bool exists(std::string name){
       auto gopt_it = opts.find(name);
@@ -214,6 +268,10 @@ class Game {
     int level_seed_high = 1;
     int game_type = 0;
     int game_n = 0;
+    std::string game_name;
+
+    // size of the concrete game class, set by REGISTER_GAME
+    size_t instance_bytes = sizeof(Game);
 
     RandGen level_seed_rand_gen;
     RandGen rand_gen;
@@ -234,11 +292,24 @@ class Game {
 
     int fixed_asset_seed = 0;
 
-    uint32_t render_buf[RES_W * RES_H];
+    // identifies the game and every option that affects level generation, for the LevelCache and LevelPack
+    uint64_t level_options_hash = 0;
+    std::shared_ptr<LevelPack> level_pack;
+    // shared by every env of a VecGame when use_level_sampler is set, otherwise levels are drawn uniformly
+    std::shared_ptr<LevelSampler> level_sampler;
+    // shared by every env of a VecGame when use_level_sweep is set
+    std::shared_ptr<LevelSweep> level_sweep;
+    // set once the sweep has no level left for this env, VecGame no longer steps it
+    bool sweep_finished = false;
+
+    // filled in by game_reset, see level-stats.h
+    int32_t level_stats[NUM_LEVEL_STATS];
 
     int cur_time = 0;
 
     bool is_waiting_for_step = false;
+    // set by VecGame::reset_to_seeds, the stepping thread calls reset_to_level instead of step when it is not -1
+    int pending_reset_seed = -1;
 
 
 
@@ -254,8 +325,21 @@ class Game {
     Game();
     void step();
     void reset();
+    // starts a new episode on level_seed, after which reset draws levels as usual
+    void reset_to_level(int level_seed);
+    void end_step(bool will_force_reset);
     void render_to_buf(void *buf, int w, int h, bool antialias);
     void parse_options(std::string name, VecOptions opt_vec);
+    virtual void memory_usage(MemoryUsage &usage);
+
+    // reset uses these to restore the level for current_level_seed from the LevelCache instead of calling
+    // game_reset, and to store the level game_reset generated, games without support do neither
+    virtual bool load_cached_level();
+    virtual void save_cached_level();
+    // copies the state game_reset left behind into level, returns false if the game does not support it
+    virtual bool capture_level(CachedLevel *level);
+    // generates the level for level_seed the way reset does and captures it, used to write a LevelPack
+    bool generate_level(int level_seed, CachedLevel *level);
 
     virtual ~Game() = 0;
     virtual void game_init() = 0;
@@ -313,6 +397,10 @@ class Game {
 
   private:
     int reset_count = 0;
+
+    uint64_t hash_level_options();
     int num_episodes_done = 0;
     float total_reward = 0.0f;
+    // the episode plays a level claimed from level_sweep, rather than one started by reset_to_level
+    bool is_sweep_episode = false;
 };
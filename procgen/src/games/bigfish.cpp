@@ -20,6 +20,7 @@ class BigFish : public BasicAbstractGame {
 
     BigFish()
         : BasicAbstractGame() {
+        set_collision_policy();
         timeout = 6000;
 
         main_width = 20;
@@ -39,6 +39,7 @@ class BossfightGame : public BasicAbstractGame {
 
     BossfightGame()
         : BasicAbstractGame() {
+        set_collision_policy();
         timeout = 4000;
 
         main_width = 20;
@@ -312,7 +313,7 @@ class BossfightGame : public BasicAbstractGame {
             float ent_y = rand_gen.rand01() * (BOTTOM_MARGIN - min_barrier_y - barrier_r) + min_barrier_y;
             float ent_x = rand_gen.rand01() * (main_width - 2 * barrier_r) + barrier_r;
 
-            auto ent = std::make_shared<Entity>(ent_x, ent_y, 0, 0, barrier_r, BARRIER);
+            auto ent = make_entity(ent_x, ent_y, 0, 0, barrier_r, barrier_r, BARRIER);
             choose_random_theme(ent);
             match_aspect_ratio(ent);
             ent->health = 3;
@@ -17,6 +17,9 @@ const int EXHAUST = 9;
 
 const int MARKER = 1003;
 
+constexpr CollisionRule BLOCKED_BY[] = {{PLAYER, CAVEWALL}};
+constexpr CollisionRule REFLECTED_BY[] = {{ENEMY, CAVEWALL}, {ENEMY, OUT_OF_BOUNDS_TYPE}};
+
 class CaveFlyerGame : public BasicAbstractGame {
   public:
     int ground_theme;
@@ -24,7 +27,10 @@ class CaveFlyerGame : public BasicAbstractGame {
 
     CaveFlyerGame()
         : BasicAbstractGame() {
+        set_collision_policy(BLOCKED_BY, REFLECTED_BY);
         mixrate = 0.9f;
+        // every contact that matters erases a bullet or ends the episode, so it is only handled once
+        report_contact_begin_only = true;
         room_manager = std::make_unique<RoomGenerator>(this);
     }
 
@@ -81,15 +87,6 @@ class CaveFlyerGame : public BasicAbstractGame {
         return BasicAbstractGame::use_block_asset(type) || (type == CAVEWALL);
     }
 
-    bool is_blocked(const std::shared_ptr<Entity> &src, int target, bool is_horizontal) override {
-        if (BasicAbstractGame::is_blocked(src, target, is_horizontal))
-            return true;
-        if (src->type == PLAYER && target == CAVEWALL)
-            return true;
-
-        return false;
-    }
-
     void handle_collision(const std::shared_ptr<Entity> &src, const std::shared_ptr<Entity> &target) override {
         if (target->type == PLAYER_BULLET) {
             bool erase_bullet = false;
@@ -98,7 +95,7 @@ class CaveFlyerGame : public BasicAbstractGame {
                 src->health -= 1;
                 erase_bullet = true;
 
-                if (src->health <= 0 && !src->will_erase) {
+                if (src->health <= 0) {
                     spawn_child(src, EXPLOSION, .5 * src->rx);
                     src->will_erase = true;
                     step_data.reward += TARGET_REWARD;
@@ -111,7 +108,7 @@ class CaveFlyerGame : public BasicAbstractGame {
                 erase_bullet = true;
             }
 
-            if (erase_bullet && !target->will_erase) {
+            if (erase_bullet) {
                 target->will_erase = true;
                 auto explosion = spawn_child(target, EXPLOSION, .5 * target->rx);
                 explosion->vx = src->vx;
@@ -120,10 +117,6 @@ class CaveFlyerGame : public BasicAbstractGame {
         }
     }
 
-    bool will_reflect(int src, int target) override {
-        return BasicAbstractGame::will_reflect(src, target) || (src == ENEMY && (target == CAVEWALL || target == out_of_bounds_object));
-    }
-
     void choose_world_dim() override {
         DistributionMode dist_diff = options.distribution_mode;
 
@@ -214,11 +207,19 @@ class CaveFlyerGame : public BasicAbstractGame {
             set_obj(i, MARKER);
         }
 
+        // the cave is carved around goal_path, so it stays open after the updates above
+        level_stats[LEVEL_STAT_PATH_LENGTH] = (int)(goal_path.size()) - 1;
+        level_stats[LEVEL_STAT_KEYS] = 0;
+        level_stats[LEVEL_STAT_DOORS] = 0;
+        level_stats[LEVEL_STAT_COINS] = 0;
+        level_stats[LEVEL_STAT_OPEN_CELLS] = (int)(goal_path.size());
+
         free_cells.clear();
 
         for (int i = 0; i < grid_size; i++) {
             if (get_obj(i) == SPACE) {
                 free_cells.push_back(i);
+                level_stats[LEVEL_STAT_OPEN_CELLS]++;
             } else if (get_obj(i) == WALL_OBJ) {
                 set_obj(i, CAVEWALL);
             }
@@ -263,6 +264,11 @@ class CaveFlyerGame : public BasicAbstractGame {
         visibility = options.distribution_mode == EasyMode ? 10 : 16;
     }
 
+    // out_of_bounds_object and visibility are all game_reset sets beyond the level itself
+    bool level_cache_fields(LevelFields &fields) override {
+        return true;
+    }
+
     void set_action_xy(int move_act) override {
         float acceleration = move_act % 3 - 1;
         if (acceleration < 0)
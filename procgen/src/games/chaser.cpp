@@ -20,6 +20,8 @@ const int ENEMY3 = 8;
 const int MARKER = 1001;
 const int ORB = 1002;
 
+constexpr CollisionRule BLOCKED_BY[] = {{ANY_TYPE, MAZE_WALL}};
+
 class ChaserGame : public BasicAbstractGame {
   public:
     std::shared_ptr<MazeGen> maze_gen;
@@ -30,6 +32,7 @@ class ChaserGame : public BasicAbstractGame {
 
     ChaserGame()
         : BasicAbstractGame() {
+        set_collision_policy(BLOCKED_BY);
         mixrate = 1;
         maxspeed = .5;
 
@@ -79,13 +82,6 @@ class ChaserGame : public BasicAbstractGame {
         agent->vy = sign(agent->vy) * maxspeed;
     }
 
-    bool is_blocked(const std::shared_ptr<Entity> &src, int target, bool is_horizontal) override {
-        if (target == MAZE_WALL)
-            return true;
-
-        return BasicAbstractGame::is_blocked(src, target, is_horizontal);
-    }
-
     int image_for_type(int type) override {
         if (type == ENEMY) {
             if (can_eat_enemies()) {
@@ -230,6 +226,12 @@ class ChaserGame : public BasicAbstractGame {
         total_orbs = (int)(free_cells.size());
         orbs_collected = 0;
 
+        level_stats[LEVEL_STAT_KEYS] = 0;
+        level_stats[LEVEL_STAT_DOORS] = 0;
+        level_stats[LEVEL_STAT_COINS] = total_orbs;
+        level_stats[LEVEL_STAT_DEAD_ENDS] = maze_gen->count_dead_ends();
+        level_stats[LEVEL_STAT_OPEN_CELLS] = maze_gen->count_open_cells();
+
         std::vector<int> marker_cells = get_cells_with_type(MARKER);
 
         for (int cell : marker_cells) {
@@ -24,6 +24,9 @@ const float PATROL_RANGE = 4;
 
 const int NUM_WALL_THEMES = 4;
 
+constexpr CollisionRule BLOCKED_BY[] = {{PLAYER, WALL_MID}, {PLAYER, WALL_TOP}};
+constexpr CollisionRule REFLECTED_BY[] = {{ENEMY, WALL_MID}, {ENEMY, WALL_TOP}, {ENEMY, ENEMY_BARRIER}};
+
 class Climber : public BasicAbstractGame {
   public:
     std::shared_ptr<Entity> goal;
@@ -34,6 +37,7 @@ class Climber : public BasicAbstractGame {
 
     Climber()
         : BasicAbstractGame() {
+        set_collision_policy(BLOCKED_BY, REFLECTED_BY);
         out_of_bounds_object = WALL_MID;
     }
 
@@ -100,10 +104,6 @@ class Climber : public BasicAbstractGame {
         return 0;
     }
 
-    bool will_reflect(int src, int target) override {
-        return BasicAbstractGame::will_reflect(src, target) || (src == ENEMY && (is_wall(target) || target == ENEMY_BARRIER));
-    }
-
     void update_agent_velocity() override {
         float mixrate_x = has_support ? mixrate : (mixrate * air_control);
         agent->vx = (1 - mixrate_x) * agent->vx + mixrate_x * maxspeed * action_vx;
@@ -125,15 +125,6 @@ class Climber : public BasicAbstractGame {
         return BasicAbstractGame::use_block_asset(type) || is_wall(type);
     }
 
-    bool is_blocked(const std::shared_ptr<Entity> &src, int target, bool is_horizontal) override {
-        if (BasicAbstractGame::is_blocked(src, target, is_horizontal))
-            return true;
-        if (src->type == PLAYER && is_wall(target))
-            return true;
-
-        return false;
-    }
-
     int image_for_type(int type) override {
         if (type == PLAYER) {
             if (!has_support) {
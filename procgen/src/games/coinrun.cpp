@@ -33,6 +33,9 @@ std::vector<const char *> GROUND_THEMES = {"Dirt", "Grass", "Planet", "Sand", "S
 
 const int NUM_GROUND_THEMES = (int)(GROUND_THEMES.size());
 
+constexpr CollisionRule BLOCKED_BY[] = {{PLAYER, WALL_MID}, {PLAYER, WALL_TOP}};
+constexpr CollisionRule REFLECTED_BY[] = {{ENEMY, WALL_MID}, {ENEMY, WALL_TOP}, {ENEMY, ENEMY_BARRIER}};
+
 class CoinRun : public BasicAbstractGame {
   public:
     std::shared_ptr<Entity> goal;
@@ -43,6 +46,7 @@ class CoinRun : public BasicAbstractGame {
 
     CoinRun()
         : BasicAbstractGame() {
+        set_collision_policy(BLOCKED_BY, REFLECTED_BY);
         visibility = 13;
         mixrate = 0.2f;
 
@@ -132,10 +136,6 @@ class CoinRun : public BasicAbstractGame {
         return 0;
     }
 
-    bool will_reflect(int src, int target) override {
-        return BasicAbstractGame::will_reflect(src, target) || (src == ENEMY && (is_wall(target) || target == ENEMY_BARRIER));
-    }
-
     void handle_grid_collision(const std::shared_ptr<Entity> &obj, int type, int i, int j) override {
         if (obj->type == PLAYER) {
             if (type == GOAL) {
@@ -196,15 +196,6 @@ class CoinRun : public BasicAbstractGame {
         return BasicAbstractGame::is_blocked_ents(src, target, is_horizontal);
     }
 
-    bool is_blocked(const std::shared_ptr<Entity> &src, int target, bool is_horizontal) override {
-        if (BasicAbstractGame::is_blocked(src, target, is_horizontal))
-            return true;
-        if (src->type == PLAYER && is_wall(target))
-            return true;
-
-        return false;
-    }
-
     int image_for_type(int type) override {
         if (type == PLAYER) {
             if (fabs(agent->vx) < .01 && action_vx == 0 && has_support) {
@@ -3,7 +3,9 @@
 #include "../roomgen.h"
 #include <set>
 #include <queue>
+#ifndef PROCGEN_HEADLESS
 #include <QPainterPath>
+#endif
 
 const float GOAL_REWARD = 10.0f;
 const float TARGET_REWARD = 3.0f;
@@ -23,6 +25,9 @@ const int FUEL= 14;
 
 const int MARKER = 1003;
 
+constexpr CollisionRule BLOCKED_BY[] = {{PLAYER, CAVEWALL}, {PLAYER, OBSTACLE}};
+constexpr CollisionRule REFLECTED_BY[] = {{ENEMY, CAVEWALL}, {ENEMY, OUT_OF_BOUNDS_TYPE}};
+
 class Collector : public BasicAbstractGame {
 
   class CellManager {
@@ -945,6 +950,7 @@ public:
 
 
     Collector() : BasicAbstractGame() {
+        set_collision_policy(BLOCKED_BY, REFLECTED_BY);
 
       register_info_buffer("state");
       register_info_buffer("state_description");
@@ -1052,17 +1058,6 @@ public:
         return BasicAbstractGame::use_block_asset(type) || (type == CAVEWALL);
     }
 
-    bool is_blocked(const std::shared_ptr<Entity> &src, int target, bool is_horizontal) override {
-        if (BasicAbstractGame::is_blocked(src, target, is_horizontal))
-            return true;
-        if (src->type == PLAYER && target == CAVEWALL)
-            return true;
-        if (src->type == PLAYER && target == OBSTACLE)
-            return true;
-
-        return false;
-    }
-
 
     void draw_gauge(QPainter &p, float x, float y, float h, float capacity, float val, QColor val_color){
       QPainterPath path;
@@ -1085,6 +1080,14 @@ public:
       }
     }
 
+    bool may_be_visible(const std::shared_ptr<Entity> &ent) override {
+      // goals also draw their gauge at a fixed position on screen
+      if (ent->type == GOAL_GREEN || ent->type == GOAL_RED){
+        return true;
+      }
+      return BasicAbstractGame::may_be_visible(ent);
+    }
+
 
     void game_draw(QPainter &p, const QRect &rect) override {
         BasicAbstractGame::game_draw(p, rect);
@@ -1114,10 +1117,6 @@ public:
         draw_gauge(p, stat_dim/2.0+0.5, 4.0, .5, world_dim, ship->fuel->get_percentage(), blue);
     }
 
-    bool will_reflect(int src, int target) override {
-        return BasicAbstractGame::will_reflect(src, target) || (src == ENEMY && (target == CAVEWALL || target == out_of_bounds_object));
-    }
-
     void choose_world_dim() override {
 
         world_dim = options.get<int32_t>("world_dim");
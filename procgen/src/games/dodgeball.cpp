@@ -22,6 +22,8 @@ const int NUM_ENEMY_THEMES = 7;
 const float ENEMY_VEL = 0.05f;
 const float BALL_V_ROT = PI * 0.23f;
 
+constexpr CollisionRule REFLECTED_BY[] = {{ENEMY, LAVA_WALL}, {ENEMY, OUT_OF_BOUNDS_TYPE}};
+
 class DodgeballGame : public BasicAbstractGame {
   public:
     std::vector<QRectF> rooms;
@@ -31,6 +33,7 @@ class DodgeballGame : public BasicAbstractGame {
 
     DodgeballGame()
         : BasicAbstractGame() {
+        set_collision_policy(CollisionRules(), REFLECTED_BY);
         mixrate = .5;
 
         enemy_fire_delay = 50;
@@ -92,10 +95,6 @@ class DodgeballGame : public BasicAbstractGame {
         return BasicAbstractGame::image_for_type(type);
     }
 
-    bool will_reflect(int src, int target) override {
-        return BasicAbstractGame::will_reflect(src, target) || (src == ENEMY && (target == LAVA_WALL || target == out_of_bounds_object));
-    }
-
     void handle_agent_collision(const std::shared_ptr<Entity> &obj) override {
         BasicAbstractGame::handle_agent_collision(obj);
 
@@ -20,6 +20,9 @@ const int KEY_DURATION = 8;
 
 const float DOOR_ASPECT_RATIO = 3.25;
 
+constexpr CollisionRule BLOCKED_BY[] = {{PLAYER, OUT_OF_BOUNDS_WALL}};
+constexpr CollisionRule REFLECTED_BY[] = {{BAD_OBJ, BARRIER}, {BAD_OBJ, WALL_OBJ}};
+
 class FruitBotGame : public BasicAbstractGame {
   public:
     float min_dim;
@@ -28,6 +31,7 @@ class FruitBotGame : public BasicAbstractGame {
 
     FruitBotGame()
         : BasicAbstractGame() {
+        set_collision_policy(BLOCKED_BY, REFLECTED_BY);
         mixrate = .5;
         maxspeed = 0.85f;
 
@@ -74,14 +78,6 @@ class FruitBotGame : public BasicAbstractGame {
         }
     }
 
-    bool will_reflect(int src, int target) override {
-        return BasicAbstractGame::will_reflect(src, target) || (src == BAD_OBJ && (target == BARRIER || target == WALL_OBJ));
-    }
-
-    bool is_blocked(const std::shared_ptr<Entity> &src, int target, bool is_horizontal) override {
-        return BasicAbstractGame::is_blocked(src, target, is_horizontal) || (src->type == PLAYER && target == OUT_OF_BOUNDS_WALL);
-    }
-
     float get_tile_aspect_ratio(const std::shared_ptr<Entity> &ent) override {
         if (ent->type == BARRIER)
             return 1;
@@ -121,7 +117,7 @@ class FruitBotGame : public BasicAbstractGame {
                 src->will_erase = true;
                 target->will_erase = true;
 
-                auto door = target->relative.lock();
+                auto door = get_entity(target->relative);
 
                 if (door) {
                     door->will_erase = true;
@@ -188,7 +184,7 @@ class FruitBotGame : public BasicAbstractGame {
             auto door = add_entity_rxy(door_x, ry, 0, 0, gapw / 2 - lock_rx, wall_ry, LOCKED_DOOR);
 
             auto lock = add_entity_rxy(lock_x, ry - lock_ry + wall_ry, 0, 0, lock_rx, lock_ry, LOCK);
-            lock->relative = door;
+            lock->relative = get_handle(door);
         }
     }
 
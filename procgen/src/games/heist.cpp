@@ -20,6 +20,7 @@ class HeistGame : public BasicAbstractGame {
 
     HeistGame()
         : BasicAbstractGame() {
+        set_collision_policy();
         maze_gen = nullptr;
         has_useful_vel_info = false;
 
@@ -140,6 +141,13 @@ class HeistGame : public BasicAbstractGame {
         maze_gen = std::make_shared<MazeGen>(&rand_gen, maze_dim);
         maze_gen->generate_maze_with_doors(num_keys);
 
+        level_stats[LEVEL_STAT_PATH_LENGTH] = maze_gen->path_length(maze_gen->find_obj(AGENT_OBJ), maze_gen->find_obj(EXIT_OBJ));
+        level_stats[LEVEL_STAT_KEYS] = num_keys;
+        level_stats[LEVEL_STAT_DOORS] = num_keys;
+        level_stats[LEVEL_STAT_COINS] = 0;
+        level_stats[LEVEL_STAT_DEAD_ENDS] = maze_gen->count_dead_ends();
+        level_stats[LEVEL_STAT_OPEN_CELLS] = maze_gen->count_open_cells();
+
         // move agent out of the way for maze generation
         agent->x = -1;
         agent->y = -1;
@@ -194,6 +202,14 @@ class HeistGame : public BasicAbstractGame {
         }
     }
 
+    bool level_cache_fields(LevelFields &fields) override {
+        fields.field(world_dim);
+        fields.field(num_keys);
+        fields.field(has_keys);
+        fields.field(options.center_agent);
+        return true;
+    }
+
     void game_step() override {
         BasicAbstractGame::game_step();
 
@@ -12,6 +12,8 @@ const int KEY_ON_RING = 11;
 const int WATER = 20;
 const int FIRE = 21;
 
+constexpr CollisionRule BLOCKED_BY[] = {{ANY_TYPE, LOCKED_DOOR}};
+
 class HeistPPGame : public BasicAbstractGame {
 
 
@@ -33,7 +35,8 @@ class HeistPPGame : public BasicAbstractGame {
     float water_bonus;
     float action_bonus;
 
-    const std::map<int,uint8_t> asset_to_state = {
+    // identical for every env, so only stored once
+    inline static const std::map<int,uint8_t> asset_to_state = {
       {SPACE, 0},
       {KEY, 11},
       {KEY+1, 12},
@@ -49,6 +52,7 @@ class HeistPPGame : public BasicAbstractGame {
 
     HeistPPGame()
         : BasicAbstractGame() {
+        set_collision_policy(BLOCKED_BY);
         maze_gen = nullptr;
         has_useful_vel_info = false;
 
@@ -111,13 +115,6 @@ class HeistPPGame : public BasicAbstractGame {
         return BasicAbstractGame::use_block_asset(type) || (type == WALL_OBJ) || (type == LOCKED_DOOR);
     }
 
-    bool is_blocked(const std::shared_ptr<Entity> &src, int target, bool is_horizontal) override {
-        if (target == LOCKED_DOOR){
-          return true;
-        }
-        return BasicAbstractGame::is_blocked(src, target, is_horizontal);
-    }
-
     bool is_blocked_ents(const std::shared_ptr<Entity> &src, const std::shared_ptr<Entity> &target, bool is_horizontal) override {
         if (target->type == LOCKED_DOOR){
             return !has_keys[target->image_theme];
@@ -209,6 +206,7 @@ class HeistPPGame : public BasicAbstractGame {
       water_bonus = options.get<float>("water_bonus");
       action_bonus = options.get<float>("action_bonus");
 
+      placement_rand_gen.set_backend(rand_gen.get_backend());
       placement_rand_gen.seed(options.get<float>("placement_seed"));
     }
 
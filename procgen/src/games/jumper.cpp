@@ -24,6 +24,8 @@ const int MAZE_SCALE = 3;
 const int JUMP_COOLDOWN = 3;
 const int NUM_WALL_THEMES = 4;
 
+constexpr CollisionRule BLOCKED_BY[] = {{PLAYER, CAVEWALL}, {PLAYER, CAVEWALL_TOP}};
+
 class Jumper : public BasicAbstractGame {
   public:
     std::shared_ptr<Entity> goal;
@@ -35,6 +37,7 @@ class Jumper : public BasicAbstractGame {
 
     Jumper()
         : BasicAbstractGame() {
+        set_collision_policy(BLOCKED_BY);
         room_manager = std::make_unique<RoomGenerator>(this);
     }
 
@@ -103,15 +106,6 @@ class Jumper : public BasicAbstractGame {
         return BasicAbstractGame::use_block_asset(type) || is_wall(type);
     }
 
-    bool is_blocked(const std::shared_ptr<Entity> &src, int target, bool is_horizontal) override {
-        if (BasicAbstractGame::is_blocked(src, target, is_horizontal))
-            return true;
-        if (src->type == PLAYER && is_wall(target))
-            return true;
-
-        return false;
-    }
-
     int image_for_type(int type) override {
         if (type == PLAYER) {
             // if (jump_delta < 0) {
@@ -171,10 +165,6 @@ class Jumper : public BasicAbstractGame {
         }
     }
 
-    bool will_reflect(int src, int target) override {
-        return BasicAbstractGame::will_reflect(src, target);
-    }
-
     bool is_space_on_ground(int x, int y) {
         if (get_obj(x, y) != SPACE)
             return false;
@@ -371,6 +361,16 @@ class Jumper : public BasicAbstractGame {
         agent->ry = 0.4f;
 
         out_of_bounds_object = CAVEWALL;
+
+        // the path the level was carved around, later changes to the grid only open more cells
+        level_stats[LEVEL_STAT_PATH_LENGTH] = (int)(goal_path.size()) - 1;
+        level_stats[LEVEL_STAT_KEYS] = 0;
+        level_stats[LEVEL_STAT_DOORS] = 0;
+        level_stats[LEVEL_STAT_COINS] = 0;
+        level_stats[LEVEL_STAT_OPEN_CELLS] = 0;
+        for (int i = 0; i < grid_size; i++) {
+            level_stats[LEVEL_STAT_OPEN_CELLS] += !is_wall(get_obj(i));
+        }
     }
 
     bool is_wall(int obj) {
@@ -12,6 +12,7 @@ class MazeGame : public BasicAbstractGame {
 
     MazeGame()
         : BasicAbstractGame() {
+        set_collision_policy();
         timeout = 500;
         random_agent_start = false;
         has_useful_vel_info = false;
@@ -70,6 +71,13 @@ class MazeGame : public BasicAbstractGame {
         maze_gen->generate_maze();
         maze_gen->place_objects(GOAL, 1);
 
+        level_stats[LEVEL_STAT_PATH_LENGTH] = maze_gen->path_length(maze_gen->grid.to_index(MAZE_OFFSET, MAZE_OFFSET), maze_gen->find_obj(GOAL));
+        level_stats[LEVEL_STAT_KEYS] = 0;
+        level_stats[LEVEL_STAT_DOORS] = 0;
+        level_stats[LEVEL_STAT_COINS] = 0;
+        level_stats[LEVEL_STAT_DEAD_ENDS] = maze_gen->count_dead_ends();
+        level_stats[LEVEL_STAT_OPEN_CELLS] = maze_gen->count_open_cells();
+
         for (int i = 0; i < grid_size; i++) {
             set_obj(i, WALL_OBJ);
         }
@@ -93,19 +101,35 @@ class MazeGame : public BasicAbstractGame {
         }
     }
 
+    bool level_cache_fields(LevelFields &fields) override {
+        fields.field(world_dim);
+        fields.field(maze_dim);
+        fields.field(options.center_agent);
+        return true;
+    }
+
+    bool get_grid_batch_rules(std::vector<GridBatchRule> &rules) override {
+        rules.push_back({GOAL, REWARD, true, true, true});
+        return true;
+    }
+
     void set_action_xy(int move_act) override {
         BasicAbstractGame::set_action_xy(move_act);
         if (action_vx != 0)
             action_vy = 0;
     }
 
+    void set_agent_facing(float vx) override {
+        if (vx > 0)
+            agent->is_reflected = true;
+        if (vx < 0)
+            agent->is_reflected = false;
+    }
+
     void game_step() override {
         BasicAbstractGame::game_step();
 
-        if (action_vx > 0)
-            agent->is_reflected = true;
-        if (action_vx < 0)
-            agent->is_reflected = false;
+        set_agent_facing(action_vx);
 
         int ix = int(agent->x);
         int iy = int(agent->y);
@@ -16,12 +16,16 @@ const int DIRT = 9;
 
 const int OOB_WALL = 10;
 
+constexpr CollisionRule BLOCKED_BY[] = {{PLAYER, BOULDER}, {PLAYER, MOVING_BOULDER}, {PLAYER, OOB_WALL}};
+constexpr CollisionRule REFLECTED_BY[] = {{ENEMY, BOULDER}, {ENEMY, DIAMOND}, {ENEMY, MOVING_BOULDER}, {ENEMY, MOVING_DIAMOND}, {ENEMY, OUT_OF_BOUNDS_TYPE}};
+
 class MinerGame : public BasicAbstractGame {
   public:
     int diamonds_remaining;
 
     MinerGame()
         : BasicAbstractGame() {
+        set_collision_policy(BLOCKED_BY, REFLECTED_BY);
         main_width = 20;
         main_height = 20;
 
@@ -53,19 +57,6 @@ class MinerGame : public BasicAbstractGame {
         }
     }
 
-    bool is_blocked(const std::shared_ptr<Entity> &src, int target, bool is_horizontal) override {
-        if (BasicAbstractGame::is_blocked(src, target, is_horizontal))
-            return true;
-        if (src->type == PLAYER && (target == BOULDER || target == MOVING_BOULDER || target == OOB_WALL))
-            return true;
-
-        return false;
-    }
-
-    bool will_reflect(int src, int target) override {
-        return BasicAbstractGame::will_reflect(src, target) || (src == ENEMY && (target == BOULDER || target == DIAMOND || target == MOVING_BOULDER || target == MOVING_DIAMOND || target == out_of_bounds_object));
-    }
-
     void handle_agent_collision(const std::shared_ptr<Entity> &obj) override {
         BasicAbstractGame::handle_agent_collision(obj);
 
@@ -0,0 +1,254 @@
+#include "grid-batch.h"
+#include "basic-abstract-game.h"
+#include "game-registry.h"
+#include "vecgame.h"
+#include <algorithm>
+
+// bits of code_blocks and out_of_bounds_blocks
+const uint8_t BLOCKS_HORIZONTAL = 1;
+const uint8_t BLOCKS_VERTICAL = 2;
+
+const uint8_t NO_RULE = 255;
+
+GridBatch::GridBatch(VecGame &venv) {
+    num_envs = venv.num_envs;
+    num_actions = venv.num_actions;
+
+    for (const auto &game : venv.games) {
+        auto basic = dynamic_cast<BasicAbstractGame *>(game.get());
+        fassert(basic != nullptr && basic->grid_step && basic->get_agent() != nullptr);
+        fassert(basic->game_name == venv.games[0]->game_name);
+        games.push_back(basic);
+
+        // reset() renders into the connected observation buffers, VecGame connects them again on the next step
+        for (auto &kv : basic->obs_buffers) {
+            kv.second.space = nullptr;
+        }
+        for (auto &kv : basic->info_buffers) {
+            kv.second.space = nullptr;
+        }
+    }
+
+    bool supported = games[0]->get_grid_batch_rules(rules);
+    fassert(supported);
+    fassert(rules.size() < NO_RULE);
+
+    default_action = games[0]->default_action;
+    fassert(0 <= default_action && default_action < num_actions);
+
+    // grid_step_velocity overwrites the action fields of the game it is called on, so it is called on a new
+    // instance of the game that is never stepped
+    auto scratch = std::dynamic_pointer_cast<BasicAbstractGame>(globalGameRegistry->at(games[0]->game_name)());
+    fassert(scratch != nullptr);
+
+    for (int a = 0; a < num_actions; a++) {
+        float vx, vy;
+        scratch->grid_step_velocity(a, &vx, &vy);
+        fassert((vx == -1 || vx == 0 || vx == 1) && (vy == -1 || vy == 0 || vy == 1));
+        move_x.push_back(int8_t(vx));
+        move_y.push_back(int8_t(vy));
+    }
+
+    width.resize(num_envs);
+    height.resize(num_envs);
+    agent_x.resize(num_envs);
+    agent_y.resize(num_envs);
+    times.resize(num_envs);
+    timeouts.resize(num_envs);
+    out_of_bounds_blocks.resize(num_envs);
+    last_move_x.resize(num_envs);
+    step_actions.resize(num_envs);
+    forced.resize(num_envs);
+    events.resize(num_envs);
+
+    space_code = (uint8_t)(code_for(SPACE));
+    load_all();
+}
+
+int GridBatch::code_for(int type) {
+    for (int code = 0; code < (int)(code_types.size()); code++) {
+        if (code_types[code] == type) {
+            return code;
+        }
+    }
+
+    BasicAbstractGame *game = games[0];
+    const auto &agent = game->get_agent();
+
+    // the agent moving into the cell must not be reflected, sub_step would move it by a fraction of a cell
+    fassert(!game->will_reflect(agent->type, type));
+    fassert(code_types.size() < 255);
+
+    uint8_t blocks = 0;
+    blocks |= game->is_blocked(agent, type, true) ? BLOCKS_HORIZONTAL : 0;
+    blocks |= game->is_blocked(agent, type, false) ? BLOCKS_VERTICAL : 0;
+
+    uint8_t rule = NO_RULE;
+    for (int r = 0; r < (int)(rules.size()); r++) {
+        if (rules[r].type == type) {
+            rule = (uint8_t)(r);
+        }
+    }
+
+    code_types.push_back(type);
+    code_blocks.push_back(blocks);
+    code_rule.push_back(rule);
+
+    return (int)(code_types.size()) - 1;
+}
+
+void GridBatch::load_all() {
+    max_cells = 0;
+    for (auto game : games) {
+        max_cells = std::max(max_cells, game->main_width * game->main_height);
+    }
+
+    cells.assign((size_t)(num_envs) * max_cells, space_code);
+
+    for (int e = 0; e < num_envs; e++) {
+        load(e);
+    }
+}
+
+void GridBatch::load(int e) {
+    BasicAbstractGame *game = games[e];
+    int w = game->main_width;
+    int h = game->main_height;
+
+    if (w * h > max_cells) {
+        // a level larger than any before, the other envs are reloaded at the new size
+        for (int other = 0; other < num_envs; other++) {
+            if (other != e) {
+                sync_game(other);
+            }
+        }
+        load_all();
+        return;
+    }
+
+    const auto &agent = game->get_agent();
+    int ax = int(agent->x);
+    int ay = int(agent->y);
+
+    // the agent must fill at most one cell and be at its center, which grid_step keeps it at
+    fassert(agent->rx <= .5 && agent->ry <= .5);
+    fassert(agent->x == ax + .5f && agent->y == ay + .5f);
+
+    width[e] = w;
+    height[e] = h;
+    agent_x[e] = ax;
+    agent_y[e] = ay;
+    times[e] = game->cur_time;
+    timeouts[e] = game->timeout;
+    last_move_x[e] = 0;
+
+    int oob = game->out_of_bounds_object;
+    out_of_bounds_blocks[e] = (game->is_blocked(agent, oob, true) ? BLOCKS_HORIZONTAL : 0) | (game->is_blocked(agent, oob, false) ? BLOCKS_VERTICAL : 0);
+
+    uint8_t *env_cells = &cells[(size_t)(e) * max_cells];
+    for (int i = 0; i < w * h; i++) {
+        env_cells[i] = (uint8_t)(code_for(game->get_obj(i)));
+    }
+}
+
+void GridBatch::step(const int32_t *actions, const uint8_t *skip, float *rewards, uint8_t *dones, uint8_t *level_completes) {
+    for (int e = 0; e < num_envs; e++) {
+        int a = actions[e];
+        fassert(-1 <= a && a < num_actions);
+        forced[e] = a == -1;
+        step_actions[e] = a == -1 ? default_action : a;
+    }
+
+    const uint8_t *blocks = code_blocks.data();
+    const uint8_t *rule_of = code_rule.data();
+
+    // moves every env using only the per env arrays, the few envs that need their game are handled below
+    for (int e = 0; e < num_envs; e++) {
+        int live = skip == nullptr || !skip[e];
+        int a = step_actions[e];
+        int w = width[e];
+        int h = height[e];
+        int x = agent_x[e];
+        int y = agent_y[e];
+        int dx = live ? move_x[a] : 0;
+        int dy = live ? move_y[a] : 0;
+        const uint8_t *env_cells = &cells[(size_t)(e) * max_cells];
+
+        // basic_step_object moves the player along y first whenever it has a y velocity, then along x
+        for (int axis = 0; axis < 2; axis++) {
+            bool vertical = (axis == 0) == (dy != 0);
+            int nx = vertical ? x : x + dx;
+            int ny = vertical ? y + dy : y;
+            uint8_t bit = vertical ? BLOCKS_VERTICAL : BLOCKS_HORIZONTAL;
+
+            bool inside = 0 <= nx && nx < w && 0 <= ny && ny < h;
+            uint8_t cell_blocks = inside ? blocks[env_cells[ny * w + nx]] : out_of_bounds_blocks[e];
+            bool moves = (nx != x || ny != y) && !(cell_blocks & bit);
+
+            x = moves ? nx : x;
+            y = moves ? ny : y;
+        }
+
+        agent_x[e] = x;
+        agent_y[e] = y;
+        last_move_x[e] = dx != 0 ? dx : last_move_x[e];
+        times[e] += live;
+
+        bool has_rule = rule_of[env_cells[y * w + x]] != NO_RULE;
+        events[e] = live && (has_rule || forced[e] || times[e] >= timeouts[e]);
+
+        rewards[e] = 0;
+        dones[e] = 0;
+        level_completes[e] = 0;
+    }
+
+    for (int e = 0; e < num_envs; e++) {
+        if (events[e]) {
+            uint8_t rule = code_rule[cells[(size_t)(e) * max_cells + agent_y[e] * width[e] + agent_x[e]]];
+            finish_step(e, rule == NO_RULE ? nullptr : &rules[rule], forced[e], rewards, dones, level_completes);
+        }
+    }
+}
+
+/*
+  Hands a step with a reward or the end of an episode to the game, which resets itself like Game::step
+*/
+void GridBatch::finish_step(int e, const GridBatchRule *rule, bool force_reset, float *rewards, uint8_t *dones, uint8_t *level_completes) {
+    BasicAbstractGame *game = games[e];
+    sync_game(e);
+
+    if (rule != nullptr && rule->consumed) {
+        cells[(size_t)(e) * max_cells + agent_y[e] * width[e] + agent_x[e]] = space_code;
+        game->set_obj(agent_x[e], agent_y[e], SPACE);
+    }
+
+    game->step_data.reward = rule != nullptr ? rule->reward : 0;
+    game->step_data.done = rule != nullptr && rule->ends_episode;
+    game->step_data.level_complete = rule != nullptr && rule->level_complete;
+    game->end_step(force_reset);
+
+    rewards[e] = game->step_data.reward;
+    dones[e] = (uint8_t)(game->step_data.done);
+    level_completes[e] = (uint8_t)(game->step_data.level_complete);
+
+    // reset() sets cur_time back to 0
+    if (game->cur_time == 0) {
+        load(e);
+    }
+}
+
+void GridBatch::sync_game(int e) {
+    const auto &agent = games[e]->get_agent();
+    agent->x = agent_x[e] + .5f;
+    agent->y = agent_y[e] + .5f;
+    if (last_move_x[e] != 0) {
+        games[e]->set_agent_facing(last_move_x[e]);
+    }
+    games[e]->cur_time = times[e];
+}
+
+void GridBatch::sync_games() {
+    for (int e = 0; e < num_envs; e++) {
+        sync_game(e);
+    }
+}
@@ -0,0 +1,101 @@
+#include "level-cache.h"
+#include "cpp-utils.h"
+#include <algorithm>
+
+size_t CachedLevel::memory_bytes() const {
+    return sizeof(CachedLevel) + cells.capacity() * sizeof(int) + entities.capacity() * sizeof(Entity) +
+           rand_gen.memory_bytes() - sizeof(RandGen) + ints.capacity() * sizeof(int32_t) + floats.capacity() * sizeof(float);
+}
+
+void LevelFields::field(int &value) {
+    if (save_to != nullptr) {
+        save_to->ints.push_back(value);
+    } else if (restore_from != nullptr) {
+        fassert(int_pos < restore_from->ints.size());
+        value = restore_from->ints[int_pos++];
+    }
+}
+
+void LevelFields::field(float &value) {
+    if (save_to != nullptr) {
+        save_to->floats.push_back(value);
+    } else if (restore_from != nullptr) {
+        fassert(float_pos < restore_from->floats.size());
+        value = restore_from->floats[float_pos++];
+    }
+}
+
+void LevelFields::field(bool &value) {
+    int as_int = value;
+    field(as_int);
+    value = as_int != 0;
+}
+
+void LevelFields::field(std::vector<bool> &values) {
+    int size = (int)(values.size());
+    field(size);
+    values.resize(size);
+
+    for (int i = 0; i < size; i++) {
+        bool value = values[i];
+        field(value);
+        values[i] = value;
+    }
+}
+
+LevelCache &LevelCache::shared() {
+    static LevelCache cache;
+    return cache;
+}
+
+void LevelCache::reserve(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    capacity = std::max(capacity, bytes);
+}
+
+std::shared_ptr<const CachedLevel> LevelCache::find(uint64_t options_hash, int level_seed) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = index.find(Key{options_hash, level_seed});
+    if (it == index.end()) {
+        counters.misses++;
+        return nullptr;
+    }
+
+    counters.hits++;
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->level;
+}
+
+void LevelCache::insert(uint64_t options_hash, int level_seed, const std::shared_ptr<const CachedLevel> &level) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    Key key{options_hash, level_seed};
+    size_t bytes = level->memory_bytes();
+
+    // another env may have generated the same level at the same time
+    if (bytes > capacity || index.find(key) != index.end()) {
+        return;
+    }
+
+    while ((size_t)(counters.bytes) + bytes > capacity) {
+        Entry &oldest = entries.back();
+        counters.bytes -= (int64_t)(oldest.bytes);
+        counters.evictions++;
+        index.erase(oldest.key);
+        entries.pop_back();
+    }
+
+    entries.push_front(Entry{key, level, bytes});
+    index[key] = entries.begin();
+    counters.bytes += (int64_t)(bytes);
+}
+
+LevelCacheStats LevelCache::stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    LevelCacheStats result = counters;
+    result.levels = (int64_t)(entries.size());
+    result.capacity_bytes = (int64_t)(capacity);
+    return result;
+}
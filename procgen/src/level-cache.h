@@ -0,0 +1,131 @@
+#pragma once
+
+/*
+
+Process-wide cache of generated levels
+
+With a bounded set of levels (num_levels > 0) every env keeps regenerating the same few levels from their
+seeds. When the level_cache_mb option is set, games that support it store the state game_reset leaves
+behind (the grid, the entities, the background choice, the random number generator and whatever fields
+the game lists in level_cache_fields) the first time a level is generated, keyed by the game, its options
+and the level seed. Later resets to the same level, in any env of the process, copy that state instead of
+running the generators again, which gives the same level and the same episode afterwards.
+
+The cache evicts the least recently used levels to stay under the largest level_cache_mb of any env in
+the process.
+
+*/
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "entity.h"
+#include "level-stats.h"
+#include "randgen.h"
+
+struct CachedLevel {
+    int main_width = 0;
+    int main_height = 0;
+    std::vector<int> cells;
+
+    std::vector<Entity> entities;
+    int agent_idx = 0;
+
+    int background_index = 0;
+    float bg_pct_x = 0.0f;
+    int out_of_bounds_object = 0;
+    float visibility = 0.0f;
+    bool grid_step = false;
+    int32_t level_stats[NUM_LEVEL_STATS] = {};
+
+    // rand_gen right after game_reset, so that the episode draws the same numbers
+    RandGen rand_gen;
+
+    // values of the game's own fields, in the order level_cache_fields visits them
+    std::vector<int32_t> ints;
+    std::vector<float> floats;
+
+    size_t memory_bytes() const;
+};
+
+/*
+  Visits the fields a game sets in game_reset that CachedLevel does not already hold. The same list of
+  field() calls is used to save a level and to restore it, so the two can't get out of sync.
+*/
+class LevelFields {
+  public:
+    // only checks whether the game supports the cache, every field is left alone
+    LevelFields(){};
+    // appends every field to the level
+    LevelFields(CachedLevel *_save_to)
+        : save_to(_save_to){};
+    // sets every field from the level
+    LevelFields(const CachedLevel *_restore_from)
+        : restore_from(_restore_from){};
+
+    void field(int &value);
+    void field(float &value);
+    void field(bool &value);
+    void field(std::vector<bool> &values);
+
+  private:
+    CachedLevel *save_to = nullptr;
+    const CachedLevel *restore_from = nullptr;
+    size_t int_pos = 0;
+    size_t float_pos = 0;
+};
+
+struct LevelCacheStats {
+    int64_t hits = 0;
+    int64_t misses = 0;
+    int64_t evictions = 0;
+    int64_t levels = 0;
+    int64_t bytes = 0;
+    int64_t capacity_bytes = 0;
+};
+
+class LevelCache {
+  public:
+    static LevelCache &shared();
+
+    // the capacity only ever grows, so an env can't shrink the cache of another
+    void reserve(size_t bytes);
+
+    // options_hash identifies the game and every option that affects level generation
+    std::shared_ptr<const CachedLevel> find(uint64_t options_hash, int level_seed);
+    void insert(uint64_t options_hash, int level_seed, const std::shared_ptr<const CachedLevel> &level);
+
+    LevelCacheStats stats();
+
+  private:
+    struct Key {
+        uint64_t options_hash;
+        int level_seed;
+
+        bool operator==(const Key &other) const {
+            return options_hash == other.options_hash && level_seed == other.level_seed;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key &key) const {
+            return (size_t)(key.options_hash ^ ((uint64_t)(uint32_t)(key.level_seed) * 0x9e3779b97f4a7c15ULL));
+        }
+    };
+
+    struct Entry {
+        Key key;
+        std::shared_ptr<const CachedLevel> level;
+        size_t bytes;
+    };
+
+    std::mutex mutex;
+    // most recently used first
+    std::list<Entry> entries;
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+    size_t capacity = 0;
+    LevelCacheStats counters;
+};
@@ -0,0 +1,323 @@
+#include "level-pack.h"
+#include "cpp-utils.h"
+#include "game.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char LEVEL_PACK_MAGIC[8] = {'P', 'G', 'L', 'E', 'V', 'E', 'L', 'S'};
+
+/*
+  Reads or writes the words of a level record. The same transfer_level is used to encode and to decode,
+  so the two can't get out of sync.
+*/
+class LevelWords {
+  public:
+    LevelWords(std::vector<uint32_t> *_out)
+        : out(_out){};
+    LevelWords(const uint32_t *_in, size_t _count)
+        : in(_in), count(_count){};
+
+    bool decoding() const {
+        return in != nullptr;
+    }
+
+    void word(uint32_t &value) {
+        if (decoding()) {
+            fassert(pos < count);
+            value = in[pos++];
+        } else {
+            out->push_back(value);
+        }
+    }
+    void word(int &value) {
+        uint32_t as_word = (uint32_t)(value);
+        word(as_word);
+        value = (int)(as_word);
+    }
+    void word(float &value) {
+        uint32_t as_word;
+        memcpy(&as_word, &value, sizeof(as_word));
+        word(as_word);
+        memcpy(&value, &as_word, sizeof(value));
+    }
+    void word(bool &value) {
+        uint32_t as_word = value;
+        word(as_word);
+        value = as_word != 0;
+    }
+
+    template <typename T>
+    void list(std::vector<T> &values) {
+        int size = (int)(values.size());
+        word(size);
+        fassert(size >= 0);
+        values.resize(size);
+        for (int i = 0; i < size; i++) {
+            word(values[i]);
+        }
+    }
+
+    bool at_end() const {
+        return pos == count;
+    }
+
+  private:
+    std::vector<uint32_t> *out = nullptr;
+    const uint32_t *in = nullptr;
+    size_t count = 0;
+    size_t pos = 0;
+};
+
+static void transfer_entity(LevelWords &words, Entity &ent) {
+    words.word(ent.x);
+    words.word(ent.y);
+    words.word(ent.vx);
+    words.word(ent.vy);
+    words.word(ent.rx);
+    words.word(ent.ry);
+    words.word(ent.type);
+    words.word(ent.image_type);
+    words.word(ent.image_theme);
+    words.word(ent.render_z);
+    words.word(ent.will_erase);
+    words.word(ent.collides_with_entities);
+    words.word(ent.collision_margin);
+    words.word(ent.rotation);
+    words.word(ent.vrot);
+    words.word(ent.is_reflected);
+    words.word(ent.fire_time);
+    words.word(ent.spawn_time);
+    words.word(ent.life_time);
+    words.word(ent.expire_time);
+    words.word(ent.use_abs_coords);
+    words.word(ent.friction);
+    words.word(ent.smart_step);
+    words.word(ent.avoids_collisions);
+    words.word(ent.auto_erase);
+    words.word(ent.alpha);
+    words.word(ent.health);
+    words.word(ent.theta);
+    words.word(ent.grow_rate);
+    words.word(ent.alpha_decay);
+    words.word(ent.climber_spawn_x);
+    words.word(ent.relative.slot);
+    words.word(ent.relative.generation);
+}
+
+static void transfer_level(LevelWords &words, CachedLevel &level) {
+    words.word(level.main_width);
+    words.word(level.main_height);
+    words.list(level.cells);
+    fassert(level.main_width * level.main_height == (int)(level.cells.size()));
+
+    words.word(level.background_index);
+    words.word(level.bg_pct_x);
+    words.word(level.out_of_bounds_object);
+    words.word(level.visibility);
+    words.word(level.grid_step);
+    for (int i = 0; i < NUM_LEVEL_STATS; i++) {
+        words.word(level.level_stats[i]);
+    }
+
+    int num_entities = (int)(level.entities.size());
+    words.word(num_entities);
+    words.word(level.agent_idx);
+    fassert(level.agent_idx >= 0 && level.agent_idx < num_entities);
+    if (words.decoding()) {
+        level.entities.clear();
+        level.entities.reserve(num_entities);
+        for (int i = 0; i < num_entities; i++) {
+            level.entities.emplace_back(0, 0, 0, 0, 0, 0, 0);
+        }
+    }
+    for (auto &ent : level.entities) {
+        transfer_entity(words, ent);
+    }
+
+    std::vector<uint32_t> rand_words;
+    if (!words.decoding()) {
+        rand_words = level.rand_gen.get_state_words();
+    }
+    words.list(rand_words);
+    if (words.decoding()) {
+        level.rand_gen.set_state_words(rand_words.data(), rand_words.size());
+    }
+
+    words.list(level.ints);
+    words.list(level.floats);
+}
+
+void encode_level(const CachedLevel &level, std::vector<uint32_t> &words) {
+    LevelWords out(&words);
+    // encoding only reads from the level
+    transfer_level(out, const_cast<CachedLevel &>(level));
+}
+
+void decode_level(const uint32_t *words, size_t count, CachedLevel *level) {
+    LevelWords in(words, count);
+    transfer_level(in, *level);
+    fassert(in.at_end());
+}
+
+static bool replace_file(const std::string &src, const std::string &dst) {
+#ifdef _WIN32
+    // rename fails on windows if the destination exists
+    remove(dst.c_str());
+#endif
+    return rename(src.c_str(), dst.c_str()) == 0;
+}
+
+void write_level_pack(const std::string &path, const std::vector<std::shared_ptr<Game>> &games, int start_level, int num_levels) {
+    fassert(games.size() > 0);
+    fassert(num_levels > 0);
+
+    const auto &first = games[0];
+    fassert(first->game_name.size() < sizeof(LevelPackHeader::env_name));
+
+    std::vector<std::vector<uint32_t>> records(num_levels);
+    std::atomic<int> next_level(0);
+    std::atomic<bool> unsupported(false);
+
+    auto generate = [&](Game *game) {
+        CachedLevel level;
+        while (true) {
+            int idx = next_level++;
+            if (idx >= num_levels) {
+                break;
+            }
+            if (!game->generate_level(start_level + idx, &level)) {
+                unsupported = true;
+                break;
+            }
+            encode_level(level, records[idx]);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (const auto &game : games) {
+        fassert(game->level_options_hash == first->level_options_hash);
+        threads.emplace_back(generate, game.get());
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    if (unsupported) {
+        fatal("%s does not support level packs with these options\n", first->game_name.c_str());
+    }
+
+    LevelPackHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LEVEL_PACK_MAGIC, sizeof(header.magic));
+    header.version = LEVEL_PACK_VERSION;
+    header.header_bytes = sizeof(LevelPackHeader);
+    header.options_hash = first->level_options_hash;
+    header.start_level = start_level;
+    header.num_levels = num_levels;
+    strcpy(header.env_name, first->game_name.c_str());
+
+    std::vector<uint64_t> offsets(num_levels + 1);
+    offsets[0] = sizeof(LevelPackHeader) + offsets.size() * sizeof(uint64_t);
+    for (int i = 0; i < num_levels; i++) {
+        offsets[i + 1] = offsets[i] + records[i].size() * sizeof(uint32_t);
+    }
+
+    // write next to the destination and rename, so that envs that have the old pack mapped keep reading it
+    std::string tmp_path = path + ".tmp";
+    FILE *f = fopen(tmp_path.c_str(), "wb");
+    if (f == nullptr) {
+        fatal("failed to open %s for writing\n", tmp_path.c_str());
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    ok = ok && fwrite(offsets.data(), sizeof(uint64_t), offsets.size(), f) == offsets.size();
+    for (const auto &record : records) {
+        ok = ok && fwrite(record.data(), sizeof(uint32_t), record.size(), f) == record.size();
+    }
+    ok = fclose(f) == 0 && ok;
+    ok = ok && replace_file(tmp_path, path);
+
+    if (!ok) {
+        fatal("failed to write level pack %s\n", path.c_str());
+    }
+}
+
+std::shared_ptr<LevelPack> LevelPack::open(const std::string &path) {
+    auto pack = get_shared_game_data<LevelPack>("level_pack/" + path);
+    std::call_once(pack->load_once, &LevelPack::load, pack.get(), path);
+    return pack;
+}
+
+void LevelPack::load(const std::string &path) {
+#ifdef _WIN32
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        fatal("failed to open level pack %s\n", path.c_str());
+    }
+    contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data = contents.data();
+    size = contents.size();
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        fatal("failed to open level pack %s\n", path.c_str());
+    }
+    struct stat st;
+    fassert(fstat(fd, &st) == 0);
+    size = (size_t)(st.st_size);
+    if (size > 0) {
+        void *mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        fassert(mapped != MAP_FAILED);
+        data = (const uint8_t *)(mapped);
+        is_mapped = true;
+    }
+    ::close(fd);
+#endif
+
+    if (size < sizeof(LevelPackHeader) || memcmp(header().magic, LEVEL_PACK_MAGIC, sizeof(LEVEL_PACK_MAGIC)) != 0) {
+        fatal("%s is not a level pack\n", path.c_str());
+    }
+
+    const auto &pack_header = header();
+    if (pack_header.version != LEVEL_PACK_VERSION) {
+        fatal("level pack %s has version %u, expected %u\n", path.c_str(), pack_header.version, LEVEL_PACK_VERSION);
+    }
+    fassert(pack_header.header_bytes == sizeof(LevelPackHeader));
+    fassert(pack_header.num_levels >= 0);
+    fassert(size >= sizeof(LevelPackHeader) + (pack_header.num_levels + 1) * sizeof(uint64_t));
+
+    offsets = (const uint64_t *)(data + sizeof(LevelPackHeader));
+    fassert(offsets[pack_header.num_levels] <= size);
+}
+
+LevelPack::~LevelPack() {
+#ifndef _WIN32
+    if (is_mapped) {
+        munmap((void *)(data), size);
+    }
+#endif
+}
+
+bool LevelPack::read(int level_seed, CachedLevel *level) const {
+    int64_t idx = (int64_t)(level_seed) - header().start_level;
+    if (idx < 0 || idx >= header().num_levels) {
+        return false;
+    }
+
+    uint64_t begin = offsets[idx];
+    uint64_t end = offsets[idx + 1];
+    fassert(begin <= end && end <= size && begin % sizeof(uint32_t) == 0);
+
+    decode_level((const uint32_t *)(data + begin), (size_t)((end - begin) / sizeof(uint32_t)), level);
+    return true;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+/*
+
+On-disk packs of pre-generated levels
+
+A level pack holds the levels [start_level, start_level + num_levels) of one game and option set, in the
+same form the LevelCache stores them: the grid, the entities and the random number generator right after
+game_reset. Envs created with the level_pack option map the file into memory, and resets to a level in
+the pack decode it from the mapping instead of generating it, so the level and the episode that follows
+are the same as without the pack. Every env in the process that uses the same file shares one mapping.
+
+File format, version 2, all values little-endian 32 bit words unless noted:
+
+    LevelPackHeader
+    uint64 offsets[num_levels + 1]    byte offset of each level record from the start of the file
+    level records
+
+A level record is the main grid size and cells, the background, visibility and grid_step fields, the
+level stats, the entities with the index of the agent, the RandGen state words, and the game's
+level_cache_fields values, each variable length list prefixed by its length. The options_hash must match the hash of the env that
+loads the pack, so a pack can't be used with options that would have generated different levels.
+
+*/
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "level-cache.h"
+
+class Game;
+
+const uint32_t LEVEL_PACK_VERSION = 2;
+
+struct LevelPackHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_bytes;
+    uint64_t options_hash;
+    int32_t start_level;
+    int32_t num_levels;
+    char env_name[32];
+};
+
+// encodes a level as 32 bit words, decode_level fasserts if the words don't hold a complete level
+void encode_level(const CachedLevel &level, std::vector<uint32_t> &words);
+void decode_level(const uint32_t *words, size_t count, CachedLevel *level);
+
+/*
+  Generates the levels [start_level, start_level + num_levels) and writes them to path, running one thread
+  per game. The games must all be of the same env and options.
+*/
+void write_level_pack(const std::string &path, const std::vector<std::shared_ptr<Game>> &games, int start_level, int num_levels);
+
+class LevelPack {
+  public:
+    // maps the file, or returns the mapping another env already opened
+    static std::shared_ptr<LevelPack> open(const std::string &path);
+
+    LevelPack(){};
+    ~LevelPack();
+
+    // returns false if level_seed is not in the pack
+    bool read(int level_seed, CachedLevel *level) const;
+
+    const LevelPackHeader &header() const {
+        return *(const LevelPackHeader *)(data);
+    }
+    size_t size_bytes() const {
+        return size;
+    }
+
+  private:
+    std::once_flag load_once;
+    void load(const std::string &path);
+
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    const uint64_t *offsets = nullptr;
+
+    // holds the file when it can't be mapped
+    std::vector<uint8_t> contents;
+    bool is_mapped = false;
+};
@@ -0,0 +1,175 @@
+#include "level-sampler.h"
+#include "cpp-utils.h"
+#include <algorithm>
+#include <cmath>
+
+LevelSampler::LevelSampler(int _level_seed_low, int _num_levels, float _temperature, float _staleness)
+    : level_seed_low(_level_seed_low), num_levels(_num_levels), temperature(_temperature), staleness(_staleness) {
+    fassert(num_levels > 0);
+    fassert(temperature > 0);
+    fassert(staleness >= 0 && staleness <= 1);
+
+    num_leaves = 1;
+    while (num_leaves < num_levels) {
+        num_leaves *= 2;
+    }
+
+    weight_tree.resize(2 * num_leaves, 0.0);
+    last_sampled_tree.resize(2 * num_leaves, 0);
+    scores.resize(num_levels, 1.0f);
+
+    for (int i = 0; i < num_levels; i++) {
+        weight_tree[num_leaves + i] = 1.0;
+    }
+    for (int node = num_leaves - 1; node >= 1; node--) {
+        weight_tree[node] = weight_tree[2 * node] + weight_tree[2 * node + 1];
+    }
+}
+
+// parents are summed again from their children rather than adjusted by the difference, so rounding errors
+// don't accumulate over many updates
+void LevelSampler::set_leaf(std::vector<double> &tree, int leaf, double value) {
+    int node = num_leaves + leaf;
+    tree[node] = value;
+    for (node /= 2; node >= 1; node /= 2) {
+        tree[node] = tree[2 * node] + tree[2 * node + 1];
+    }
+}
+
+void LevelSampler::set_leaf(std::vector<int64_t> &tree, int leaf, int64_t value) {
+    int node = num_leaves + leaf;
+    tree[node] = value;
+    for (node /= 2; node >= 1; node /= 2) {
+        tree[node] = tree[2 * node] + tree[2 * node + 1];
+    }
+}
+
+void LevelSampler::update_scores(const int32_t *level_seeds, const float *new_scores, int count) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (int i = 0; i < count; i++) {
+        int leaf = level_seeds[i] - level_seed_low;
+        if (leaf < 0 || leaf >= num_levels) {
+            continue;
+        }
+
+        float score = new_scores[i];
+        fassert(score >= 0 && std::isfinite(score));
+        scores[leaf] = score;
+        set_leaf(weight_tree, leaf, temperature == 1.0f ? score : std::pow((double)(score), 1.0 / temperature));
+    }
+}
+
+/*
+  u is in [0, total weight), a child is only entered if it has weight so that rounding can't
+  select an unused leaf or a level with a score of 0
+*/
+int LevelSampler::sample_weight(double u) {
+    int node = 1;
+    while (node < num_leaves) {
+        double left = weight_tree[2 * node];
+        if (u < left || weight_tree[2 * node + 1] <= 0) {
+            node = 2 * node;
+        } else {
+            u -= left;
+            node = 2 * node + 1;
+        }
+    }
+    return node - num_leaves;
+}
+
+/*
+  The staleness of a level is num_samples - last sampled, which changes for every level on every sample.
+  The tree holds the sum of the last sampled counts, and the staleness of a subtree is num_samples times
+  its number of levels minus that sum.
+*/
+int LevelSampler::sample_staleness(double u) {
+    int node = 1;
+    int first_leaf = 0;
+    int span = num_leaves;
+
+    while (node < num_leaves) {
+        span /= 2;
+        int left_levels = std::max(0, std::min(num_levels - first_leaf, span));
+        int right_levels = std::max(0, std::min(num_levels - first_leaf - span, span));
+        double left = (double)(num_samples * left_levels - last_sampled_tree[2 * node]);
+        double right = (double)(num_samples * right_levels - last_sampled_tree[2 * node + 1]);
+
+        if (u < left || right <= 0) {
+            node = 2 * node;
+        } else {
+            u -= left;
+            node = 2 * node + 1;
+            first_leaf += span;
+        }
+    }
+    return node - num_leaves;
+}
+
+int LevelSampler::draw_leaf(RandGen &rand_gen) {
+    double total_weight = weight_tree[1];
+    double total_staleness = (double)(num_samples * num_levels - last_sampled_tree[1]);
+
+    bool use_staleness = staleness > 0 && total_staleness > 0 && (staleness >= 1 || rand_gen.rand01() < staleness);
+
+    int leaf;
+    if (use_staleness) {
+        leaf = sample_staleness(rand_gen.rand01() * total_staleness);
+    } else if (total_weight > 0) {
+        leaf = sample_weight(rand_gen.rand01() * total_weight);
+    } else {
+        leaf = rand_gen.randn(num_levels);
+    }
+    fassert(leaf < num_levels);
+    return leaf;
+}
+
+void LevelSampler::record_sample(int leaf) {
+    num_samples++;
+    set_leaf(last_sampled_tree, leaf, num_samples);
+}
+
+int LevelSampler::sample(RandGen &rand_gen) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    int leaf = draw_leaf(rand_gen);
+    record_sample(leaf);
+
+    return level_seed_low + leaf;
+}
+
+int LevelSampler::sample_for_env(RandGen &rand_gen, int env_index) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    int leaf = draw_leaf(rand_gen);
+    staged_samples.push_back(std::make_pair(env_index, leaf));
+
+    return level_seed_low + leaf;
+}
+
+/*
+  The draws of one env are staged in the order it made them, the stable sort keeps that order
+  while putting the envs in index order
+*/
+void LevelSampler::commit_env_samples() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::stable_sort(staged_samples.begin(), staged_samples.end(),
+                     [](const std::pair<int, int> &a, const std::pair<int, int> &b) { return a.first < b.first; });
+    for (const auto &staged : staged_samples) {
+        record_sample(staged.second);
+    }
+    staged_samples.clear();
+}
+
+float LevelSampler::get_score(int level_seed) {
+    std::lock_guard<std::mutex> lock(mutex);
+    int leaf = level_seed - level_seed_low;
+    fassert(leaf >= 0 && leaf < num_levels);
+    return scores[leaf];
+}
+
+int64_t LevelSampler::get_num_samples() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return num_samples;
+}
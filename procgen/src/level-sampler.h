@@ -0,0 +1,72 @@
+#pragma once
+
+/*
+
+Prioritized level sampling for a bounded set of levels
+
+With the use_level_sampler option, Game::reset draws level seeds from a LevelSampler shared by every env
+of a VecGame instead of uniformly. Scores are pushed from Python in batches with
+libenv_update_level_scores, and the sampler mixes two distributions, as in prioritized level replay
+(https://arxiv.org/abs/2010.03934):
+
+    P(level) = (1 - staleness) * score^(1 / temperature) / sum of the same
+               + staleness * (samples so far - sample count when level was last drawn) / sum of the same
+
+Both are kept in sum-trees over the level range, so updates and samples are O(log n). Levels start with
+a score of 1, so the sampler is uniform until scores are pushed. While every score is 0, scores are
+ignored and levels are drawn uniformly.
+
+Envs of a VecGame draw with sample_for_env, which reads the trees as they were at the start of the step
+and only stages the staleness update. VecGame applies the staged draws in env order with commit_env_samples
+once every env has stepped, so the levels drawn don't depend on the order the stepping threads ran in.
+VecGame::update_level_scores waits for a step in progress before updating the scores, so they only change
+between steps, and with the same seeds a venv draws the same levels with any number of threads.
+
+*/
+
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "randgen.h"
+
+class LevelSampler {
+  public:
+    LevelSampler(int _level_seed_low, int _num_levels, float _temperature, float _staleness);
+
+    // seeds outside the level range are ignored
+    void update_scores(const int32_t *level_seeds, const float *scores, int count);
+    // draws from rand_gen, so that each env samples its own reproducible sequence
+    int sample(RandGen &rand_gen);
+    // like sample, but the draw only counts towards staleness once commit_env_samples is called
+    int sample_for_env(RandGen &rand_gen, int env_index);
+    void commit_env_samples();
+
+    float get_score(int level_seed);
+    int64_t get_num_samples();
+
+  private:
+    std::mutex mutex;
+
+    int level_seed_low;
+    int num_levels;
+    float temperature;
+    float staleness;
+
+    // complete binary trees with the root at 1 and leaf i at num_leaves + i, unused leaves are 0
+    int num_leaves;
+    std::vector<double> weight_tree;
+    std::vector<int64_t> last_sampled_tree;
+    std::vector<float> scores;
+
+    int64_t num_samples = 0;
+    // env index and leaf of the draws that sample_for_env staged
+    std::vector<std::pair<int, int>> staged_samples;
+
+    void set_leaf(std::vector<double> &tree, int leaf, double value);
+    void set_leaf(std::vector<int64_t> &tree, int leaf, int64_t value);
+    int sample_weight(double u);
+    int sample_staleness(double u);
+    int draw_leaf(RandGen &rand_gen);
+    void record_sample(int leaf);
+};
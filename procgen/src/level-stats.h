@@ -0,0 +1,27 @@
+#pragma once
+
+/*
+
+Statistics of a level that games compute while generating it
+
+They are reported in the optional level_stats info space, in this order. A game sets every statistic
+that applies to it, counting 0 for objects it does not have, and leaves -1 for the ones it can't compute.
+Path lengths and cell counts are in grid cells.
+
+*/
+
+#include <cstdint>
+
+enum LevelStat {
+    // moves from the agent's start to the goal through open cells, ignoring enemies and locked doors
+    LEVEL_STAT_PATH_LENGTH = 0,
+    LEVEL_STAT_KEYS = 1,
+    LEVEL_STAT_DOORS = 2,
+    // coins, orbs and other objects that are collected for reward
+    LEVEL_STAT_COINS = 3,
+    // open cells with exactly one open neighbor
+    LEVEL_STAT_DEAD_ENDS = 4,
+    LEVEL_STAT_OPEN_CELLS = 5,
+};
+
+const int NUM_LEVEL_STATS = 6;
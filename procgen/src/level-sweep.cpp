@@ -0,0 +1,45 @@
+#include "level-sweep.h"
+#include "cpp-utils.h"
+
+LevelSweep::LevelSweep(int _start_level, int _num_levels)
+    : start_level(_start_level), num_levels(_num_levels), cursor(0), num_recorded(0) {
+    fassert(num_levels > 0);
+    returns.resize(num_levels, 0.0f);
+    lengths.resize(num_levels, -1);
+    level_completes.resize(num_levels, 0);
+}
+
+int LevelSweep::claim() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!released.empty()) {
+        int level_seed = released.back();
+        released.pop_back();
+        return level_seed;
+    }
+
+    if (cursor >= num_levels) {
+        return -1;
+    }
+    return start_level + cursor++;
+}
+
+void LevelSweep::release(int level_seed) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    int idx = level_seed - start_level;
+    fassert(idx >= 0 && idx < cursor);
+    fassert(lengths[idx] == -1);
+    released.push_back(level_seed);
+}
+
+void LevelSweep::record(int level_seed, float episode_return, int length, bool level_complete) {
+    int idx = level_seed - start_level;
+    fassert(idx >= 0 && idx < num_levels);
+    // each level is claimed by a single env, so no other thread writes these entries
+    fassert(lengths[idx] == -1);
+    returns[idx] = episode_return;
+    lengths[idx] = length;
+    level_completes[idx] = level_complete;
+    num_recorded++;
+}
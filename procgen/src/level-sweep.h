@@ -0,0 +1,51 @@
+#pragma once
+
+/*
+
+Deterministic evaluation of every level in a bounded set
+
+With the use_level_sweep option, the envs of a VecGame share a LevelSweep. Every reset claims the next
+unplayed level, so each level in [start_level, start_level + num_levels) is played exactly once, and an
+env that finishes early picks up more levels instead of waiting for the others. When no level is left,
+the env is finished and VecGame stops stepping it. The return, length and level_complete of each
+episode are recorded by level. An env that is moved to another level with reset_to_level before the
+episode of its claimed level ends releases that level, and the next claim plays it instead.
+
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+class LevelSweep {
+  public:
+    LevelSweep(int _start_level, int _num_levels);
+
+    // returns the seed of the next unclaimed level, or -1 once every level has been claimed
+    int claim();
+    // returns a claimed level whose episode will not end, so that it is claimed again
+    void release(int level_seed);
+    // called once per claimed level when its episode ends
+    void record(int level_seed, float episode_return, int length, bool level_complete);
+
+    int get_num_levels() const {
+        return num_levels;
+    }
+    int get_num_recorded() const {
+        return num_recorded;
+    }
+
+    // results by level, a length of -1 means the episode of that level has not ended yet
+    std::vector<float> returns;
+    std::vector<int32_t> lengths;
+    std::vector<uint8_t> level_completes;
+
+  private:
+    int start_level;
+    int num_levels;
+    std::mutex mutex;
+    int cursor;
+    std::vector<int> released;
+    std::atomic<int> num_recorded;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+/*
+
+Time spent in each phase of level generation, used by levelgen_benchmark
+
+Code marks the phase it belongs to with PROFILE_LEVELGEN_PHASE(phase) at the start of a scope. Phases nest,
+and time is only charged to the innermost one, so entities spawned while a game builds its level count as
+LEVELGEN_SPAWN rather than LEVELGEN_GENERATOR. Time outside of any phase is not counted.
+
+The timers only exist when PROCGEN_PROFILE_LEVELGEN is defined, which is only the case for the benchmark,
+otherwise the macro expands to nothing.
+
+*/
+
+#include <chrono>
+
+enum LevelGenPhase {
+    // everything in a reset that is not part of another phase
+    LEVELGEN_OTHER = 0,
+    LEVELGEN_WORLD_DIM = 1,
+    // clearing the grid and entities and adding the agent in BasicAbstractGame::game_reset
+    LEVELGEN_SETUP = 2,
+    LEVELGEN_BACKGROUND = 3,
+    // the game specific part of game_reset, such as MazeGen, RoomGenerator or the platformer sections
+    LEVELGEN_GENERATOR = 4,
+    // spawn_entity, spawn_entities and reposition, including the retries to avoid collisions
+    LEVELGEN_SPAWN = 5,
+};
+
+const int NUM_LEVELGEN_PHASES = 6;
+
+const char *const LEVELGEN_PHASE_NAMES[NUM_LEVELGEN_PHASES] = {"other", "world_dim", "setup", "background", "generator", "spawn"};
+
+struct LevelGenProfile {
+    double seconds[NUM_LEVELGEN_PHASES] = {0};
+    int current = LEVELGEN_OTHER;
+    int depth = 0;
+    std::chrono::steady_clock::time_point last;
+};
+
+// one profile per thread, so that envs stepped on different threads don't mix their timings
+inline LevelGenProfile &levelgen_profile() {
+    static thread_local LevelGenProfile profile;
+    return profile;
+}
+
+class LevelGenTimer {
+  public:
+    LevelGenTimer(int phase) {
+        auto &profile = levelgen_profile();
+        auto now = std::chrono::steady_clock::now();
+        if (profile.depth > 0) {
+            profile.seconds[profile.current] += std::chrono::duration<double>(now - profile.last).count();
+        }
+        parent = profile.current;
+        profile.current = phase;
+        profile.depth++;
+        profile.last = now;
+    }
+
+    ~LevelGenTimer() {
+        auto &profile = levelgen_profile();
+        auto now = std::chrono::steady_clock::now();
+        profile.seconds[profile.current] += std::chrono::duration<double>(now - profile.last).count();
+        profile.current = parent;
+        profile.depth--;
+        profile.last = now;
+    }
+
+  private:
+    int parent;
+};
+
+#ifdef PROCGEN_PROFILE_LEVELGEN
+#define LEVELGEN_TIMER_NAME(line) levelgen_timer_##line
+#define LEVELGEN_TIMER(phase, line) LevelGenTimer LEVELGEN_TIMER_NAME(line)(phase)
+#define PROFILE_LEVELGEN_PHASE(phase) LEVELGEN_TIMER(phase, __LINE__)
+#else
+#define PROFILE_LEVELGEN_PHASE(phase)
+#endif
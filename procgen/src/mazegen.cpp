@@ -16,22 +16,51 @@ MazeGen::MazeGen(RandGen *_rand_gen, int _maze_dim) {
     rand_gen = _rand_gen;
     maze_dim = _maze_dim;
     array_dim = maze_dim + 2;
-    cell_sets.resize(array_dim * array_dim);
-    cell_sets_idxs.resize(array_dim * array_dim);
+    cell_parents.resize(array_dim * array_dim);
+    cell_is_free.resize(array_dim * array_dim);
     free_cells.resize(array_dim * array_dim);
     grid.resize(array_dim, array_dim);
 }
 
+// root of the set containing the cell, with path halving
 int MazeGen::lookup(int x, int y) {
-    return cell_sets_idxs[maze_dim * y + x];
+    int cell = maze_dim * y + x;
+
+    while (cell_parents[cell] != cell) {
+        cell_parents[cell] = cell_parents[cell_parents[cell]];
+        cell = cell_parents[cell];
+    }
+
+    return cell;
+}
+
+void MazeGen::reset_cells() {
+    num_free_cells = 0;
+
+    for (int i = 0; i < maze_dim * maze_dim; i++) {
+        cell_parents[i] = i;
+        cell_is_free[i] = 0;
+    }
+}
+
+// frees both cells and the wall between them, and merges their sets
+void MazeGen::join_cells(int x1, int y1, int x2, int y2) {
+    int x0 = (x1 + x2) / 2;
+    int y0 = (y1 + y2) / 2;
+
+    set_free_cell(x1, y1);
+    set_free_cell(x0, y0);
+    set_free_cell(x2, y2);
+
+    cell_parents[lookup(x1, y1)] = lookup(x2, y2);
 }
 
 void MazeGen::set_free_cell(int x, int y) {
     grid.set(x + MAZE_OFFSET, y + MAZE_OFFSET, SPACE);
     int cell = maze_dim * y + x;
-    if (free_cell_set.find(cell) == free_cell_set.end()) {
+    if (!cell_is_free[cell]) {
         free_cells[num_free_cells] = cell;
-        free_cell_set.insert(cell);
+        cell_is_free[cell] = 1;
         num_free_cells += 1;
     }
 }
@@ -123,20 +152,7 @@ void MazeGen::generate_maze() {
 
     std::vector<Wall> walls;
 
-    num_free_cells = 0;
-    free_cell_set.clear();
-
-    std::set<int> *s0 = &cell_sets[0];
-    s0->clear();
-    s0->insert(0);
-    cell_sets_idxs[0] = 0;
-
-    for (int i = 1; i < maze_dim * maze_dim; i++) {
-        std::set<int> *s1 = &cell_sets[i];
-        s1->clear();
-        s1->insert(i);
-        cell_sets_idxs[i] = i;
-    }
+    reset_cells();
 
     for (int i = 1; i < maze_dim; i += 2) {
         for (int j = 0; j < maze_dim; j += 2) {
@@ -154,38 +170,25 @@ void MazeGen::generate_maze() {
         }
     }
 
-    while (walls.size() > 0) {
-        int n = rand_gen->randn((int)(walls.size()));
-        Wall wall = walls[n];
+    std::vector<int> wall_idxs(walls.size());
+    for (int i = 0; i < (int)(walls.size()); i++) {
+        wall_idxs[i] = i;
+    }
 
-        int s0_idx = lookup(wall.x1, wall.y1);
-        s0 = &cell_sets[s0_idx];
-        int s1_idx = lookup(wall.x2, wall.y2);
-        std::set<int> *s1 = &cell_sets[s1_idx];
+    // visiting every wall in a random order draws the same numbers as repeatedly erasing a random wall
+    for (int n : rand_gen->choose_n(wall_idxs, (int)(wall_idxs.size()))) {
+        const Wall &wall = walls[n];
 
         int x0 = (wall.x1 + wall.x2) / 2;
         int y0 = (wall.y1 + wall.y2) / 2;
-        int center = maze_dim * y0 + x0;
 
         bool can_remove =
             (grid.get(x0 + MAZE_OFFSET, y0 + MAZE_OFFSET) == WALL_OBJ) &&
-            (s0_idx != s1_idx);
+            (lookup(wall.x1, wall.y1) != lookup(wall.x2, wall.y2));
 
         if (can_remove) {
-            set_free_cell(wall.x1, wall.y1);
-            set_free_cell(x0, y0);
-            set_free_cell(wall.x2, wall.y2);
-
-            s1->insert(s0->begin(), s0->end());
-            s1->insert(center);
-
-            std::set<int>::iterator it;
-            for (it = s1->begin(); it != s1->end(); ++it) {
-                cell_sets_idxs[*it] = s1_idx;
-            }
+            join_cells(wall.x1, wall.y1, wall.x2, wall.y2);
         }
-
-        walls.erase(walls.begin() + n);
     }
 }
 
@@ -213,20 +216,7 @@ void MazeGen::generate_maze(int start, int end) {
 
     std::vector<Wall> walls;
 
-    num_free_cells = 0;
-    free_cell_set.clear();
-
-    std::set<int> *s0 = &cell_sets[0];
-    s0->clear();
-    s0->insert(0);
-    cell_sets_idxs[0] = 0;
-
-    for (int i = 1; i < maze_dim * maze_dim; i++) {
-        std::set<int> *s1 = &cell_sets[i];
-        s1->clear();
-        s1->insert(i);
-        cell_sets_idxs[i] = i;
-    }
+    reset_cells();
 
     int x_offset = start_x % 2;
     int y_offset = end_y % 2;
@@ -279,61 +269,31 @@ void MazeGen::generate_maze(int start, int end) {
       }
 
       if (found){
-        int s0_idx = lookup(wall.x1, wall.y1);
-        s0 = &cell_sets[s0_idx];
-        int s1_idx = lookup(wall.x2, wall.y2);
-        std::set<int> *s1 = &cell_sets[s1_idx];
-        int x0 = (wall.x1 + wall.x2) / 2;
-        int y0 = (wall.y1 + wall.y2) / 2;
-        int center = maze_dim * y0 + x0;
-
-        set_free_cell(wall.x1, wall.y1);
-        set_free_cell(x0, y0);
-        set_free_cell(wall.x2, wall.y2);
-        s1->insert(s0->begin(), s0->end());
-        s1->insert(center);
-
-        std::set<int>::iterator it;
-        for (it = s1->begin(); it != s1->end(); ++it) {
-            cell_sets_idxs[*it] = s1_idx;
-        }
-
+        join_cells(wall.x1, wall.y1, wall.x2, wall.y2);
+        // the order of the remaining walls decides the scan above and the choose_n order below
         walls.erase(walls.begin() + r_offset);
       }
     }
 
-    while (walls.size() > 0) {
-        int n = rand_gen->randn((int)(walls.size()));
-        Wall wall = walls[n];
+    std::vector<int> wall_idxs(walls.size());
+    for (int i = 0; i < (int)(walls.size()); i++) {
+        wall_idxs[i] = i;
+    }
 
-        int s0_idx = lookup(wall.x1, wall.y1);
-        s0 = &cell_sets[s0_idx];
-        int s1_idx = lookup(wall.x2, wall.y2);
-        std::set<int> *s1 = &cell_sets[s1_idx];
+    // visiting every wall in a random order draws the same numbers as repeatedly erasing a random wall
+    for (int n : rand_gen->choose_n(wall_idxs, (int)(wall_idxs.size()))) {
+        const Wall &wall = walls[n];
 
         int x0 = (wall.x1 + wall.x2) / 2;
         int y0 = (wall.y1 + wall.y2) / 2;
-        int center = maze_dim * y0 + x0;
 
         bool can_remove =
             (grid.get(x0 + MAZE_OFFSET, y0 + MAZE_OFFSET) == WALL_OBJ) &&
-            (s0_idx != s1_idx);
+            (lookup(wall.x1, wall.y1) != lookup(wall.x2, wall.y2));
 
         if (can_remove) {
-            set_free_cell(wall.x1, wall.y1);
-            set_free_cell(x0, y0);
-            set_free_cell(wall.x2, wall.y2);
-
-            s1->insert(s0->begin(), s0->end());
-            s1->insert(center);
-
-            std::set<int>::iterator it;
-            for (it = s1->begin(); it != s1->end(); ++it) {
-                cell_sets_idxs[*it] = s1_idx;
-            }
+            join_cells(wall.x1, wall.y1, wall.x2, wall.y2);
         }
-
-        walls.erase(walls.begin() + n);
     }
 
     for(int i=0; i<maze_dim; i++){
@@ -498,3 +458,69 @@ void MazeGen::place_objects(int start_obj, int num_objs) {
                  coin_cell / maze_dim + MAZE_OFFSET, start_obj + j);
     }
 }
+
+bool MazeGen::is_open(int idx) {
+    int obj = get_obj(idx);
+    return obj != INVALID_OBJ && obj != WALL_OBJ;
+}
+
+int MazeGen::find_obj(int type) {
+    for (int i = 0; i < array_dim * array_dim; i++) {
+        if (get_obj(i) == type) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+  Breadth first search over open cells, returns -1 if dst can't be reached
+*/
+int MazeGen::path_length(int src, int dst) {
+    if (src < 0 || dst < 0 || !is_open(src) || !is_open(dst)) {
+        return -1;
+    }
+
+    std::vector<int> dists(array_dim * array_dim, -1);
+    std::vector<int> queue;
+    queue.push_back(src);
+    dists[src] = 0;
+
+    const int offsets[4] = {-1, 1, -array_dim, array_dim};
+
+    for (size_t pos = 0; pos < queue.size(); pos++) {
+        int idx = queue[pos];
+        if (idx == dst) {
+            return dists[idx];
+        }
+
+        for (int offset : offsets) {
+            // the grid border is always invalid, so neighbors of open cells are always in bounds
+            int next = idx + offset;
+            if (dists[next] < 0 && is_open(next)) {
+                dists[next] = dists[idx] + 1;
+                queue.push_back(next);
+            }
+        }
+    }
+
+    return -1;
+}
+
+int MazeGen::count_open_cells() {
+    int count = 0;
+    for (int i = 0; i < array_dim * array_dim; i++) {
+        count += is_open(i);
+    }
+    return count;
+}
+
+int MazeGen::count_dead_ends() {
+    int count = 0;
+    for (int i = 0; i < array_dim * array_dim; i++) {
+        if (is_open(i) && is_open(i - 1) + is_open(i + 1) + is_open(i - array_dim) + is_open(i + array_dim) == 1) {
+            count++;
+        }
+    }
+    return count;
+}
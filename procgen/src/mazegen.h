@@ -4,6 +4,12 @@
 
 Generate a maze using kruskal's algorithm
 
+Cells are joined with a flat array union-find. Walls are visited in the order given by
+RandGen::choose_n, so with stream_compatible set the same seed produces the same maze as before,
+and without it the order comes from an O(n) shuffle instead. The compatible order still erases
+from a vector below RandGen's Fenwick tree threshold, since which element each draw picks depends
+on the order of the remaining elements. generate_maze(start, end) is unsupported and keeps its erase.
+
 */
 
 #include <memory>
@@ -24,24 +30,34 @@ class MazeGen {
     void generate_maze_with_doors(int num_doors);
     // void generate_maze_with_doors(int num_doors, int start, int end);
     void place_objects(int start_obj, int num_objs);
+
+    // statistics of the generated maze for level_stats, indices are grid indices and every cell that is
+    // not a wall counts as open, including doors
+    int find_obj(int type);
+    int path_length(int src, int dst);
+    int count_open_cells();
+    int count_dead_ends();
   private:
     RandGen *rand_gen;
     int maze_dim;
     int array_dim;
 
     int num_free_cells;
-    std::vector<std::set<int>> cell_sets;
-    std::vector<int> cell_sets_idxs;
-    std::set<int> free_cell_set;
+    // union-find over maze cells, a cell is the root of its set when it is its own parent
+    std::vector<int> cell_parents;
+    std::vector<uint8_t> cell_is_free;
     std::vector<int> free_cells;
 
     void get_neighbors(int idx, int type, std::vector<int> &neighbors);
     int lookup(int x, int y);
+    void reset_cells();
+    void join_cells(int x1, int y1, int x2, int y2);
 
     void set_free_cell(int x, int y);
     void set_obj(int idx, int type);
     int to_index(int x, int y);
     int get_obj(int idx);
+    bool is_open(int idx);
     std::vector<int> filter_cells(int type);
     int expand_to_type(std::set<int> &s0, std::set<int> &s1, int type);
 };
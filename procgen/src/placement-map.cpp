@@ -0,0 +1,109 @@
+#include "placement-map.h"
+#include "cpp-utils.h"
+#include <algorithm>
+#include <math.h>
+
+// cells per axis, more cells reject less often but take longer to reset and block
+const int MAX_PLACEMENT_CELLS = 64;
+
+void PlacementMap::Axis::reset(float min, float max, float cell_size) {
+    if (max <= min) {
+        lo = (min + max) / 2;
+        cell = 0;
+        n = 1;
+        return;
+    }
+
+    lo = min;
+    n = std::max(1, std::min(MAX_PLACEMENT_CELLS, int(ceil((max - min) / cell_size))));
+    cell = (max - min) / n;
+}
+
+bool PlacementMap::Axis::covered(float center, float half, int *first, int *last) const {
+    float min = center - half;
+    float max = center + half;
+
+    if (cell == 0) {
+        *first = 0;
+        *last = 0;
+        return min < lo && lo < max;
+    }
+
+    // cell i covers [lo + i * cell, lo + (i + 1) * cell]
+    *first = std::max(0, int(floor((min - lo) / cell)) + 1);
+    *last = std::min(n - 1, int(ceil((max - lo) / cell)) - 2);
+
+    // floating point rounding can put the boundary cells on either side, so check them exactly
+    while (*first <= *last && !(lo + *first * cell > min)) {
+        (*first)++;
+    }
+    while (*first <= *last && !(lo + (*last + 1) * cell < max)) {
+        (*last)--;
+    }
+
+    return *first <= *last;
+}
+
+void PlacementMap::reset(float x0, float y0, float x1, float y1, float cell_size) {
+    fassert(cell_size > 0);
+
+    ax.reset(x0, x1, cell_size);
+    ay.reset(y0, y1, cell_size);
+
+    blocked.assign(ax.n * ay.n, 0);
+    row_free.assign(ay.n, ax.n);
+    total_free = ax.n * ay.n;
+}
+
+void PlacementMap::block(float x, float y, float hx, float hy) {
+    int x_first, x_last, y_first, y_last;
+
+    if (!ax.covered(x, hx, &x_first, &x_last) || !ay.covered(y, hy, &y_first, &y_last)) {
+        return;
+    }
+
+    for (int j = y_first; j <= y_last; j++) {
+        for (int i = x_first; i <= x_last; i++) {
+            uint8_t &cell = blocked[j * ax.n + i];
+
+            if (!cell) {
+                cell = 1;
+                row_free[j]--;
+                total_free--;
+            }
+        }
+    }
+}
+
+bool PlacementMap::sample(RandGen &rand_gen, float *x, float *y) const {
+    if (total_free == 0) {
+        return false;
+    }
+
+    int rank = rand_gen.randn(total_free);
+
+    int j = 0;
+    while (rank >= row_free[j]) {
+        rank -= row_free[j];
+        j++;
+    }
+
+    int i = 0;
+    for (;; i++) {
+        if (!blocked[j * ax.n + i]) {
+            if (rank == 0) {
+                break;
+            }
+            rank--;
+        }
+    }
+
+    *x = ax.lo + (i + rand_gen.rand01()) * ax.cell;
+    *y = ay.lo + (j + rand_gen.rand01()) * ay.cell;
+
+    return true;
+}
+
+size_t PlacementMap::memory_bytes() const {
+    return blocked.capacity() * sizeof(uint8_t) + row_free.capacity() * sizeof(int);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+/*
+
+Free space map for placing a new object without colliding with existing ones
+
+The range of possible centers is split into a lattice of equal cells. Every obstacle forbids an open rect of
+centers, and marks the cells that lie entirely inside it as blocked. Sampling picks a uniformly random cell
+that is not blocked and a uniformly random point inside it. Points in cells that are only partly covered
+by an obstacle can still collide, so callers test the point and sample again if it does, which keeps the
+result uniform over the free space while only rejecting near the edges of obstacles.
+
+*/
+
+#include <cstdint>
+#include <vector>
+#include "randgen.h"
+
+class PlacementMap {
+  public:
+    // centers are placed in [x0, x1] x [y0, y1], an empty range always gives its midpoint
+    void reset(float x0, float y0, float x1, float y1, float cell_size);
+
+    // forbids every center (cx, cy) with fabs(cx - x) < hx && fabs(cy - y) < hy
+    void block(float x, float y, float hx, float hy);
+
+    // false if every cell is blocked
+    bool sample(RandGen &rand_gen, float *x, float *y) const;
+
+    size_t memory_bytes() const;
+
+  private:
+    struct Axis {
+        float lo = 0;
+        float cell = 0;
+        int n = 1;
+
+        void reset(float min, float max, float cell_size);
+        // cells that lie entirely inside the open interval (center - half, center + half)
+        bool covered(float center, float half, int *first, int *last) const;
+    };
+
+    Axis ax;
+    Axis ay;
+    std::vector<uint8_t> blocked;
+    std::vector<int> row_free;
+    int total_free = 0;
+};
@@ -0,0 +1,31 @@
+#include "qt-headless.h"
+#include <fstream>
+
+const unsigned char PNG_SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+static uint32_t read_big_endian(const unsigned char *bytes) {
+    return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | (uint32_t)bytes[3];
+}
+
+/*
+  All image assets are pngs, where the first chunk is always IHDR and starts with the width and height
+*/
+QImage::QImage(const QString &path) {
+    std::ifstream file(path.toStdString(), std::ios::binary);
+    if (!file) {
+        // like QImageReader, try the path with the suffix of the supported format appended
+        file.open(path.toStdString() + ".png", std::ios::binary);
+    }
+    unsigned char header[24];
+
+    if (!file.read((char *)header, sizeof(header))) {
+        return;
+    }
+
+    if (!std::equal(PNG_SIGNATURE, PNG_SIGNATURE + 8, header) || !std::equal(header + 12, header + 16, "IHDR")) {
+        return;
+    }
+
+    w = (int)(read_big_endian(header + 16));
+    h = (int)(read_big_endian(header + 20));
+}
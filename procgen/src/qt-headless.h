@@ -0,0 +1,373 @@
+#pragma once
+
+/*
+
+Stand-ins for the parts of the Qt API used by procgen, used when building libenv_core with PROCGEN_HEADLESS
+
+Geometry types behave like their Qt counterparts since game logic depends on them. Images only keep
+their dimensions, which are used for aspect ratios, and all painting is a no-op, so rendered
+observations are black.
+
+*/
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <string>
+
+typedef unsigned char uchar;
+
+namespace Qt {
+enum GlobalColor {
+    black,
+    white,
+};
+enum PenStyle {
+    NoPen,
+};
+} // namespace Qt
+
+class QByteArray {
+  public:
+    QByteArray(const std::string &_str) : str(_str) {
+    }
+    const char *constData() const {
+        return str.c_str();
+    }
+
+  private:
+    std::string str;
+};
+
+class QString {
+  public:
+    QString() {
+    }
+    QString(const char *_str) : str(_str) {
+    }
+    QString(const std::string &_str) : str(_str) {
+    }
+
+    static QString fromStdString(const std::string &_str) {
+        return QString(_str);
+    }
+    std::string toStdString() const {
+        return str;
+    }
+    QByteArray toUtf8() const {
+        return QByteArray(str);
+    }
+    QString toLower() const {
+        std::string lower = str;
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+        return QString(lower);
+    }
+
+    QString operator+(const QString &other) const {
+        return QString(str + other.str);
+    }
+    friend QString operator+(const char *lhs, const QString &rhs) {
+        return QString(lhs + rhs.str);
+    }
+
+  private:
+    std::string str;
+};
+
+class QColor {
+  public:
+    QColor() {
+    }
+    QColor(Qt::GlobalColor color) {
+        int value = color == Qt::white ? 255 : 0;
+        r = g = b = value;
+    }
+    QColor(int _r, int _g, int _b, int _a = 255) : r(_r), g(_g), b(_b), a(_a) {
+    }
+
+    int red() const {
+        return r;
+    }
+    int green() const {
+        return g;
+    }
+    int blue() const {
+        return b;
+    }
+    int alpha() const {
+        return a;
+    }
+    void setAlpha(int _a) {
+        a = _a;
+    }
+    void setAlphaF(double _a) {
+        a = int(_a * 255);
+    }
+
+  private:
+    int r = 0;
+    int g = 0;
+    int b = 0;
+    int a = 255;
+};
+
+class QPointF {
+  public:
+    QPointF() {
+    }
+    QPointF(double _x, double _y) : xp(_x), yp(_y) {
+    }
+
+    double x() const {
+        return xp;
+    }
+    double y() const {
+        return yp;
+    }
+
+  private:
+    double xp = 0;
+    double yp = 0;
+};
+
+class QRectF {
+  public:
+    QRectF() {
+    }
+    QRectF(double _x, double _y, double _w, double _h) : xp(_x), yp(_y), w(_w), h(_h) {
+    }
+
+    double x() const {
+        return xp;
+    }
+    double y() const {
+        return yp;
+    }
+    double width() const {
+        return w;
+    }
+    double height() const {
+        return h;
+    }
+    double left() const {
+        return xp;
+    }
+    double top() const {
+        return yp;
+    }
+    double right() const {
+        return xp + w;
+    }
+    double bottom() const {
+        return yp + h;
+    }
+    QPointF center() const {
+        return QPointF(xp + w / 2, yp + h / 2);
+    }
+
+    void setX(double _x) {
+        w += xp - _x;
+        xp = _x;
+    }
+    void setY(double _y) {
+        h += yp - _y;
+        yp = _y;
+    }
+    void setWidth(double _w) {
+        w = _w;
+    }
+    void setHeight(double _h) {
+        h = _h;
+    }
+    QRectF adjusted(double dx1, double dy1, double dx2, double dy2) const {
+        return QRectF(xp + dx1, yp + dy1, w - dx1 + dx2, h - dy1 + dy2);
+    }
+
+  private:
+    double xp = 0;
+    double yp = 0;
+    double w = 0;
+    double h = 0;
+};
+
+class QRect {
+  public:
+    QRect() {
+    }
+    QRect(int _x, int _y, int _w, int _h) : xp(_x), yp(_y), w(_w), h(_h) {
+    }
+
+    int x() const {
+        return xp;
+    }
+    int y() const {
+        return yp;
+    }
+    int width() const {
+        return w;
+    }
+    int height() const {
+        return h;
+    }
+    operator QRectF() const {
+        return QRectF(xp, yp, w, h);
+    }
+
+  private:
+    int xp = 0;
+    int yp = 0;
+    int w = 0;
+    int h = 0;
+};
+
+class QImage {
+  public:
+    enum Format {
+        Format_RGB32,
+        Format_ARGB32,
+        Format_ARGB32_Premultiplied,
+        Format_RGB888,
+    };
+
+    QImage() {
+    }
+    QImage(int _w, int _h, Format format) : w(_w), h(_h) {
+    }
+    QImage(uchar *data, int _w, int _h, int bytes_per_line, Format format) : w(_w), h(_h) {
+    }
+    // only reads the image size from the file header, a missing or unsupported file gives an empty image
+    QImage(const QString &path);
+
+    int width() const {
+        return w;
+    }
+    int height() const {
+        return h;
+    }
+    // no pixel data is ever allocated
+    int64_t sizeInBytes() const {
+        return 0;
+    }
+    QImage mirrored(bool horizontal, bool vertical) const {
+        return *this;
+    }
+    QImage convertToFormat(Format format) const {
+        return *this;
+    }
+    QImage scaled(int _w, int _h) const {
+        return QImage(_w, _h, Format_RGB32);
+    }
+    void fill(const QColor &color) {
+    }
+
+  private:
+    int w = 0;
+    int h = 0;
+};
+
+class QPen {
+  public:
+    QPen() {
+    }
+    QPen(Qt::PenStyle style) {
+    }
+    QPen(const QColor &color, double width = 1) {
+    }
+    void setWidth(int width) {
+    }
+};
+
+class QBrush {
+  public:
+    QBrush() {
+    }
+    QBrush(const QColor &color) {
+    }
+};
+
+class QPainterPath {
+  public:
+    QPainterPath() {
+    }
+    ~QPainterPath() {
+    }
+
+    void moveTo(double x, double y) {
+    }
+    void moveTo(const QPointF &point) {
+    }
+    void lineTo(double x, double y) {
+    }
+    void lineTo(const QPointF &point) {
+    }
+    void addRect(const QRectF &rect) {
+    }
+    void addEllipse(const QRectF &rect) {
+    }
+    void addRoundedRect(const QRectF &rect, double xr, double yr) {
+    }
+    void closeSubpath() {
+    }
+};
+
+class QPainter {
+  public:
+    enum RenderHint {
+        Antialiasing,
+        SmoothPixmapTransform,
+    };
+    enum CompositionMode {
+        CompositionMode_SourceOver,
+        CompositionMode_Source,
+    };
+
+    QPainter() {
+    }
+    QPainter(QImage *device) {
+    }
+
+    void setRenderHint(RenderHint hint, bool on = true) {
+    }
+    void setCompositionMode(CompositionMode mode) {
+    }
+    void setOpacity(double opacity) {
+    }
+    void setPen(const QPen &pen) {
+    }
+    void setPen(const QColor &color) {
+    }
+    void setPen(Qt::PenStyle style) {
+    }
+    void setBrush(const QBrush &brush) {
+    }
+    void save() {
+    }
+    void restore() {
+    }
+    void translate(double dx, double dy) {
+    }
+    void rotate(double angle) {
+    }
+
+    template <typename... Args>
+    void fillRect(const Args &...args) {
+    }
+    template <typename... Args>
+    void drawRect(const Args &...args) {
+    }
+    template <typename... Args>
+    void drawEllipse(const Args &...args) {
+    }
+    template <typename... Args>
+    void drawLine(const Args &...args) {
+    }
+    template <typename... Args>
+    void drawImage(const Args &...args) {
+    }
+    template <typename... Args>
+    void drawPath(const Args &...args) {
+    }
+    template <typename... Args>
+    void fillPath(const Args &...args) {
+    }
+};
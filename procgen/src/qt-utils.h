@@ -6,8 +6,12 @@ Qt utility functions
 
 */
 
+#ifdef PROCGEN_HEADLESS
+#include "qt-headless.h"
+#else
 #include <QRect>
 #include <QColor>
+#endif
 
 inline QRectF adjust_rect(const QRectF &base_rect, const QRectF &adjusting_rect) {
     QRectF rect = QRectF(base_rect.x() + base_rect.width() * adjusting_rect.x(),
@@ -1,24 +1,47 @@
 #include "randgen.h"
 #include "cpp-utils.h"
-#include <set>
+#include <algorithm>
+#include <utility>
+
+const uint64_t PCG_DEFAULT_STREAM = 1442695040888963407ULL;
+
+RandGenBackend rand_gen_backend_from_name(const std::string &name) {
+    if (name == "mt19937") {
+        return MT19937Backend;
+    } else if (name == "pcg32") {
+        return PCG32Backend;
+    }
+    fatal("invalid rand_gen_backend %s\n", name.c_str());
+    return MT19937Backend;
+}
+
+RandGen::RandGen() {
+    is_seeded = false;
+    backend = MT19937Backend;
+    pcg_state = 0;
+    pcg_inc = PCG_DEFAULT_STREAM;
+    mt_seed = 0;
+    mt_draws = 0;
+}
 
 int RandGen::randint(int low, int high) {
     fassert(is_seeded);
-    uint32_t x = stdgen();
+    uint32_t x = next_uint32();
     uint32_t range = high - low;
     return low + (x % range);
 }
 
 int RandGen::randn(int high) {
     fassert(is_seeded);
-    uint32_t x = stdgen();
+    uint32_t x = next_uint32();
     return (x % high);
 }
 
 float RandGen::rand01() {
     fassert(is_seeded);
-    uint32_t x = stdgen();
-    return (float)((double)(x) / ((double)(stdgen.max()) + 1));
+    uint32_t x = next_uint32();
+    // both backends produce the full range of 32 bit values
+    return (float)((double)(x) / ((double)(std::mt19937::max()) + 1));
 }
 
 bool RandGen::randbool() {
@@ -45,42 +68,148 @@ int RandGen::choose_one(std::vector<int> &elems) {
     return elems[randn((int)(elems.size()))];
 }
 
+// above this size, erasing from the remaining elements is slower than a Fenwick tree lookup
+const int FENWICK_MIN_ELEMS = 8192;
+
+/*
+  Repeatedly draws an index into the remaining elements, picks that element and removes it.
+  For large inputs the remaining elements are tracked in a Fenwick tree instead of erased from a
+  vector, so that each pick finds the element with the given rank in O(log n) while drawing the same numbers.
+  Small inputs keep the ordered erase, a swap-remove would reorder the remaining elements and change the picks.
+*/
 std::vector<int> RandGen::choose_n(const std::vector<int> &elems, int n) {
-    std::vector<int> chosen;
-    std::vector<int> rem_elems;
+    int num_elems = (int)(elems.size());
+
+    if (n > num_elems) {
+        return elems;
+    }
+
+    if (!stream_compatible) {
+        return shuffle_choose_n(elems, n);
+    }
 
-    for (int elem : elems) {
-        rem_elems.push_back(elem);
+    std::vector<int> chosen(n);
+
+    if (num_elems < FENWICK_MIN_ELEMS) {
+        std::vector<int> rem_elems(elems);
+
+        for (int c = 0; c < n; c++) {
+            int idx = randn((int)(rem_elems.size()));
+            chosen[c] = rem_elems[idx];
+            rem_elems.erase(rem_elems.begin() + idx);
+        }
+
+        return chosen;
+    }
+
+    // the tree is padded to a power of two so the search needs no bounds checks, padding counts as absent
+    int tree_size = 1;
+    while (tree_size < num_elems) {
+        tree_size *= 2;
     }
 
-    if (n > (int)(elems.size())) {
-        return rem_elems;
+    // every element starts out present, so each node covers lowbit(i) elements
+    std::vector<int> tree(tree_size + 1);
+    for (int i = 1; i <= tree_size; i++) {
+        int lowbit = i & -i;
+        tree[i] = std::max(0, std::min(i, num_elems) - (i - lowbit));
     }
 
-    while (int(chosen.size()) < n) {
-        int next_elem_idx = randn((int)(rem_elems.size()));
-        chosen.push_back(rem_elems[next_elem_idx]);
-        rem_elems.erase(rem_elems.begin() + next_elem_idx);
+    for (int c = 0; c < n; c++) {
+        int rank = randn(num_elems - c) + 1;
+
+        int pos = 0;
+        for (int step = tree_size / 2; step > 0; step /= 2) {
+            int count = tree[pos + step];
+            bool skip = count < rank;
+            pos += skip ? step : 0;
+            rank -= skip ? count : 0;
+        }
+
+        chosen[c] = elems[pos];
+
+        for (int i = pos + 1; i <= tree_size; i += i & -i) {
+            tree[i] -= 1;
+        }
     }
 
     return chosen;
 }
 
 std::vector<int> RandGen::simple_choose(int n, int k) {
-    std::vector<int> chosen(k, 0);
-    std::set<int> set;
-
     fassert(k <= n);
 
+    if (!stream_compatible) {
+        return shuffle_choose(n, k);
+    }
+
+    std::vector<int> chosen(k, 0);
+    std::vector<bool> taken(n, false);
+
     for (int i = 0; i < k; i++) {
         int next = randn(n);
 
-        while (set.find(next) != set.end()) {
+        while (taken[next]) {
             next = randn(n);
         }
 
         chosen[i] = next;
-        set.insert(next);
+        taken[next] = true;
+    }
+
+    return chosen;
+}
+
+// partial Fisher-Yates shuffle
+std::vector<int> RandGen::shuffle_choose_n(const std::vector<int> &elems, int n) {
+    std::vector<int> chosen = elems;
+    int num_elems = (int)(elems.size());
+
+    if (n > num_elems) {
+        return chosen;
+    }
+
+    for (int i = 0; i < n; i++) {
+        int j = i + randn(num_elems - i);
+        std::swap(chosen[i], chosen[j]);
+    }
+
+    chosen.resize(n);
+    return chosen;
+}
+
+std::vector<int> RandGen::shuffle_choose(int n, int k) {
+    fassert(k <= n);
+
+    std::vector<int> chosen(n);
+    for (int i = 0; i < n; i++) {
+        chosen[i] = i;
+    }
+
+    for (int i = 0; i < k; i++) {
+        int j = i + randn(n - i);
+        std::swap(chosen[i], chosen[j]);
+    }
+
+    chosen.resize(k);
+    return chosen;
+}
+
+// reservoir sampling (Algorithm R), a single pass over elems
+std::vector<int> RandGen::reservoir_choose_n(const std::vector<int> &elems, int n) {
+    int num_elems = (int)(elems.size());
+
+    if (n > num_elems) {
+        return elems;
+    }
+
+    std::vector<int> chosen(elems.begin(), elems.begin() + n);
+
+    for (int i = n; i < num_elems; i++) {
+        int j = randn(i + 1);
+        if (j < n) {
+            chosen[j] = elems[i];
+        }
     }
 
     return chosen;
@@ -88,10 +217,112 @@ std::vector<int> RandGen::simple_choose(int n, int k) {
 
 int RandGen::randint() {
     fassert(is_seeded);
-    return stdgen();
+    return next_uint32();
 }
 
 void RandGen::seed(int seed) {
-    stdgen.seed(seed);
+    if (backend == PCG32Backend) {
+        // scramble the seed with splitmix64 so that consecutive level seeds start far apart
+        uint64_t z = (uint64_t)(uint32_t)seed + 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        z = z ^ (z >> 31);
+
+        pcg_inc = PCG_DEFAULT_STREAM;
+        pcg_state = 0;
+        next_uint32();
+        pcg_state += z;
+        next_uint32();
+    } else {
+        if (stdgen == nullptr) {
+            stdgen = std::make_unique<std::mt19937>();
+        }
+        stdgen->seed(seed);
+        mt_seed = (uint32_t)(seed);
+        mt_draws = 0;
+    }
     is_seeded = true;
-}
\ No newline at end of file
+}
+
+void RandGen::advance(uint64_t delta) {
+    fassert(is_seeded);
+
+    if (backend == PCG32Backend) {
+        // jump ahead in O(log delta) steps, see "Random Number Generation with Arbitrary Strides" (Brown, 1994)
+        uint64_t cur_mult = PCG_MULTIPLIER;
+        uint64_t cur_plus = pcg_inc;
+        uint64_t acc_mult = 1;
+        uint64_t acc_plus = 0;
+
+        while (delta > 0) {
+            if (delta & 1) {
+                acc_mult *= cur_mult;
+                acc_plus = acc_plus * cur_mult + cur_plus;
+            }
+            cur_plus = (cur_mult + 1) * cur_plus;
+            cur_mult *= cur_mult;
+            delta /= 2;
+        }
+
+        pcg_state = acc_mult * pcg_state + acc_plus;
+    } else {
+        stdgen->discard(delta);
+        mt_draws += delta;
+    }
+}
+
+void RandGen::copy_state(const RandGen &other) {
+    backend = other.backend;
+    is_seeded = other.is_seeded;
+    pcg_state = other.pcg_state;
+    pcg_inc = other.pcg_inc;
+    mt_seed = other.mt_seed;
+    mt_draws = other.mt_draws;
+
+    if (other.stdgen == nullptr) {
+        stdgen = nullptr;
+    } else if (stdgen == nullptr) {
+        stdgen = std::make_unique<std::mt19937>(*other.stdgen);
+    } else {
+        *stdgen = *other.stdgen;
+    }
+}
+
+std::vector<uint32_t> RandGen::get_state_words() const {
+    return {(uint32_t)(backend), (uint32_t)(is_seeded), (uint32_t)(pcg_state), (uint32_t)(pcg_state >> 32), (uint32_t)(pcg_inc),
+            (uint32_t)(pcg_inc >> 32), (uint32_t)(stdgen != nullptr), mt_seed, (uint32_t)(mt_draws), (uint32_t)(mt_draws >> 32)};
+}
+
+void RandGen::set_state_words(const uint32_t *words, size_t count) {
+    fassert(count == 10);
+    backend = (RandGenBackend)(words[0]);
+    is_seeded = words[1] != 0;
+    pcg_state = (uint64_t)(words[2]) | ((uint64_t)(words[3]) << 32);
+    pcg_inc = (uint64_t)(words[4]) | ((uint64_t)(words[5]) << 32);
+    mt_seed = words[7];
+    mt_draws = (uint64_t)(words[8]) | ((uint64_t)(words[9]) << 32);
+
+    if (words[6] == 0) {
+        stdgen = nullptr;
+        return;
+    }
+
+    // replaying the draws is much cheaper than storing the mt19937 state for the few thousand draws of a level
+    if (stdgen == nullptr) {
+        stdgen = std::make_unique<std::mt19937>();
+    }
+    stdgen->seed(mt_seed);
+    stdgen->discard(mt_draws);
+}
+
+void RandGen::set_backend(RandGenBackend _backend) {
+    backend = _backend;
+    is_seeded = false;
+    if (backend != MT19937Backend) {
+        stdgen = nullptr;
+    }
+}
+
+size_t RandGen::memory_bytes() const {
+    return sizeof(RandGen) + (stdgen != nullptr ? sizeof(std::mt19937) : 0);
+}
@@ -4,13 +4,30 @@
 
 Random number generator with consistent behavior across platforms
 
+Two backends are available. MT19937Backend is the default and reproduces all existing levels.
+PCG32Backend (https://www.pcg-random.org) has 16 bytes of state, so seeding and jumping ahead
+are O(1) and O(log n) rather than initializing or discarding the 2.5KB mt19937 state. It
+produces different levels for the same seed.
+
 */
 
 #include <random>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum RandGenBackend {
+    MT19937Backend = 0,
+    PCG32Backend = 1,
+};
+
+const uint64_t PCG_MULTIPLIER = 6364136223846793005ULL;
+
+RandGenBackend rand_gen_backend_from_name(const std::string &name);
 
 class RandGen {
   public:
-    std::mt19937 stdgen;
+    RandGen();
     int randint(int low, int high);
     int randn(int high);
     float rand01();
@@ -23,6 +40,58 @@ class RandGen {
     std::vector<int> simple_choose(int n, int k);
     void seed(int seed);
 
+    // O(n) sampling without replacement, these produce different results than choose_n
+    // and simple_choose for the same seed
+    std::vector<int> shuffle_choose_n(const std::vector<int> &elems, int n);
+    std::vector<int> shuffle_choose(int n, int k);
+    // the chosen elements are not in random order, use this when only the set matters
+    std::vector<int> reservoir_choose_n(const std::vector<int> &elems, int n);
+
+    // When set, choose_n and simple_choose consume random numbers exactly like they always have,
+    // so existing seeds keep producing identical levels. When cleared, they use the O(n) shuffle variants.
+    bool stream_compatible = true;
+
+    // skip the next delta numbers of the sequence
+    void advance(uint64_t delta);
+
+    // makes this generator continue exactly where other is, including its backend
+    void copy_state(const RandGen &other);
+
+    // the full state as 32 bit words, so that it can be written to a file and restored with set_state_words
+    std::vector<uint32_t> get_state_words() const;
+    void set_state_words(const uint32_t *words, size_t count);
+
+    // changing the backend requires the generator to be seeded again
+    void set_backend(RandGenBackend _backend);
+    RandGenBackend get_backend() const {
+        return backend;
+    }
+
+    size_t memory_bytes() const;
+
   private:
     bool is_seeded;
-};
\ No newline at end of file
+    RandGenBackend backend;
+
+    // only allocated when the mt19937 backend is used
+    std::unique_ptr<std::mt19937> stdgen;
+
+    uint64_t pcg_state;
+    uint64_t pcg_inc;
+
+    // the mt19937 state is 2.5KB, so get_state_words saves its seed and the number of numbers drawn since
+    uint32_t mt_seed;
+    uint64_t mt_draws;
+
+    uint32_t next_uint32() {
+        if (backend == PCG32Backend) {
+            uint64_t old_state = pcg_state;
+            pcg_state = old_state * PCG_MULTIPLIER + pcg_inc;
+            uint32_t xorshifted = (uint32_t)(((old_state >> 18u) ^ old_state) >> 27u);
+            uint32_t rot = (uint32_t)(old_state >> 59u);
+            return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+        }
+        mt_draws++;
+        return (*stdgen)();
+    }
+};
@@ -1,5 +1,6 @@
 #include "resources.h"
 #include "cpp-utils.h"
+#include <map>
 
 QString global_resource_root;
 
@@ -6,9 +6,14 @@ Load assets stored as individual image files
 
 */
 
+#ifdef PROCGEN_HEADLESS
+#include "qt-headless.h"
+#else
 #include <QtGui/QPainter>
+#endif
 #include <iostream>
 #include <memory>
+#include <vector>
 
 std::shared_ptr<QImage> load_resource_ptr(QString relpath, QImage::Format format = QImage::Format_ARGB32_Premultiplied);
 
@@ -1,106 +1,186 @@
 #include "roomgen.h"
+#include <algorithm>
+#include <cstdint>
 
-int RoomGenerator::count_neighbors(int idx, int type) {
-    int x, y;
-    game->to_grid_xy(idx, &x, &y);
-    int neighbors = 0;
+// bits of each word shifted right by s with the low bits of the next word shifted in, for 0 <= s < 64
+static uint64_t shifted_word(const uint64_t *row, int k, int s) {
+    return s == 0 ? row[k] : (row[k] >> s) | (row[k + 1] << (64 - s));
+}
+
+/*
+  Each cell becomes a wall when at least 5 of the 9 cells in the 3x3 square around it are walls, with cells
+  outside the grid counting as walls when out_of_bounds_object is WALL_OBJ.
+
+  The wall bitset is copied into rows padded by one cell on every side, so the square around bit x of a
+  word is bits x, x + 1 and x + 2 of three padded rows. Those 9 bits are added for 64 cells at once with
+  bitwise adders.
+*/
+void RoomGenerator::update() {
+    int words_per_row;
+    game->get_type_rows(WALL_OBJ, wall_rows, &words_per_row);
+    game->get_type_rows(SPACE, space_rows, &words_per_row);
+
+    int h = (int)(wall_rows.size()) / words_per_row;
+    int w = game->grid_size / h;
+    // get_obj returns out_of_bounds_object for any cell outside the grid
+    bool outside_is_wall = game->get_obj(-1, -1) == WALL_OBJ;
+
+    // w + 2 bits per padded row, plus a zero word so shifted_word can always read the next word
+    int padded_words = (w + 2 + 63) / 64 + 1;
+    padded_rows.assign(padded_words * (h + 2), 0);
+
+    for (int y = 0; y < h; y++) {
+        const uint64_t *src = &wall_rows[y * words_per_row];
+        uint64_t *dst = &padded_rows[(y + 1) * padded_words];
+
+        for (int k = 0; k < words_per_row; k++) {
+            dst[k] |= src[k] << 1;
+            dst[k + 1] |= src[k] >> 63;
+        }
+    }
 
-    for (int i = -1; i <= 1; i++) {
-        for (int j = -1; j <= 1; j++) {
-            int curr_obj = game->get_obj(x + i, y + j);
+    if (outside_is_wall) {
+        for (int y = 0; y < h + 2; y++) {
+            uint64_t *row = &padded_rows[y * padded_words];
+            bool border_row = y == 0 || y == h + 1;
 
-            if (curr_obj == type) {
-                neighbors++;
+            for (int x = 0; x < w + 2; x++) {
+                if (border_row || x == 0 || x == w + 1) {
+                    row[x / 64] |= (uint64_t)(1) << (x % 64);
+                }
             }
         }
     }
 
-    return neighbors;
-}
+    for (int y = 0; y < h; y++) {
+        for (int k = 0; k < words_per_row; k++) {
+            // ones and carries of each row's 3 cell sum, the carry has weight 2
+            uint64_t ones[3], twos[3];
+
+            for (int r = 0; r < 3; r++) {
+                const uint64_t *row = &padded_rows[(y + r) * padded_words];
+                uint64_t a = shifted_word(row, k, 0);
+                uint64_t b = shifted_word(row, k, 1);
+                uint64_t c = shifted_word(row, k, 2);
+                ones[r] = a ^ b ^ c;
+                twos[r] = (a & b) | (c & (a ^ b));
+            }
 
-void RoomGenerator::update() {
-    // update cellular automata
-    std::vector<int> next_cells;
+            // the total is sum_ones + 2 * (number of set bits among the 3 twos and carry)
+            uint64_t sum_ones = ones[0] ^ ones[1] ^ ones[2];
+            uint64_t carry = (ones[0] & ones[1]) | (ones[2] & (ones[0] ^ ones[1]));
 
-    for (int i = 0; i < game->grid_size; i++) {
-        if (count_neighbors(i, WALL_OBJ) >= 5) {
-            next_cells.push_back(WALL_OBJ);
-        } else {
-            next_cells.push_back(SPACE);
+            uint64_t pair0_one = twos[0] ^ twos[1];
+            uint64_t pair0_two = twos[0] & twos[1];
+            uint64_t pair1_one = twos[2] ^ carry;
+            uint64_t pair1_two = twos[2] & carry;
+
+            uint64_t at_least_3 = (pair0_two & pair1_two) | ((pair0_two | pair1_two) & (pair0_one | pair1_one));
+            uint64_t exactly_2 = ((pair0_two ^ pair1_two) & ~(pair0_one | pair1_one)) | (pair0_one & pair1_one);
+
+            // at least 5 walls
+            uint64_t next = at_least_3 | (exactly_2 & sum_ones);
+
+            // only cells that are not already what they become are written
+            int word = y * words_per_row + k;
+            uint64_t changed = (next & ~wall_rows[word]) | (~next & ~space_rows[word]);
+            int x_end = std::min(w, (k + 1) * 64);
+
+            for (int x = k * 64; x < x_end; x++) {
+                if ((changed >> (x % 64)) & 1) {
+                    game->set_obj(x, y, (next >> (x % 64)) & 1 ? WALL_OBJ : SPACE);
+                }
+            }
         }
     }
+}
 
-    for (int i = 0; i < game->grid_size; i++) {
-        game->set_obj(i, next_cells[i]);
+void RoomGenerator::start_visit() {
+    if ((int)(visit_stamps.size()) != game->grid_size || visit_epoch == UINT32_MAX) {
+        visit_stamps.assign(game->grid_size, 0);
+        visit_epoch = 0;
     }
+
+    visit_epoch++;
 }
 
-void RoomGenerator::build_room(int idx, std::set<int> &room) {
-    std::queue<int> curr;
+bool RoomGenerator::is_space(int x, int y) {
+    if (game->to_grid_idx(x, y) == INVALID_IDX) {
+        // cells outside the grid are never part of a room
+        fassert(game->get_obj(x, y) != SPACE);
+        return false;
+    }
 
+    return game->get_obj(x, y) == SPACE;
+}
+
+// idx is only part of the room if a neighbor leads back to it, which leaves out a single isolated cell
+void RoomGenerator::build_room(int idx, std::vector<int> &room) {
     if (game->get_obj(idx) != SPACE)
         return;
 
-    curr.push(idx);
-
-    while (curr.size() > 0) {
-        int curr_idx = curr.front();
-        curr.pop();
-
-        if (game->get_obj(curr_idx) != SPACE)
-            continue;
+    size_t start = room.size();
+    visit(idx);
+    room.push_back(idx);
 
+    for (size_t search_idx = start; search_idx < room.size(); search_idx++) {
         int x, y;
-        game->to_grid_xy(curr_idx, &x, &y);
+        game->to_grid_xy(room[search_idx], &x, &y);
 
         for (int i = -1; i <= 1; i++) {
             for (int j = -1; j <= 1; j++) {
-                if ((i == 0 || j == 0) && (i + j != 0)) {
+                if ((i == 0 || j == 0) && (i + j != 0) && is_space(x + i, y + j)) {
                     int next_idx = game->to_grid_idx(x + i, y + j);
 
-                    if (!set_contains(room, next_idx) && game->get_obj(next_idx) == SPACE) {
-                        curr.push(next_idx);
-                        room.insert(next_idx);
+                    if (!visited(next_idx)) {
+                        visit(next_idx);
+                        room.push_back(next_idx);
                     }
                 }
             }
         }
     }
+
+    // a neighbor leads back to idx whenever there is one
+    if (room.size() == start + 1) {
+        room.pop_back();
+    }
 }
 
 void RoomGenerator::find_path(int src, int dst, std::vector<int> &path) {
-    std::set<int> covered;
     std::vector<int> expanded;
     std::vector<int> parents;
 
     if (game->get_obj(src) != SPACE)
         return;
 
+    // src is not marked, so like every other cell it is covered when a neighbor first reaches it
+    start_visit();
+
     expanded.push_back(src);
     parents.push_back(-1);
 
     int search_idx = 0;
 
+    // only SPACE cells are ever expanded
     while (search_idx < int(expanded.size())) {
         int curr_idx = expanded[search_idx];
 
         if (curr_idx == dst)
             break;
-        if (game->get_obj(curr_idx) != SPACE)
-            continue;
 
         int x, y;
         game->to_grid_xy(curr_idx, &x, &y);
 
         for (int i = -1; i <= 1; i++) {
             for (int j = -1; j <= 1; j++) {
-                if ((i == 0 || j == 0) && (i + j != 0)) {
+                if ((i == 0 || j == 0) && (i + j != 0) && is_space(x + i, y + j)) {
                     int next_idx = game->to_grid_idx(x + i, y + j);
 
-                    if (!set_contains(covered, next_idx) && game->get_obj(next_idx) == SPACE) {
+                    if (!visited(next_idx)) {
                         expanded.push_back(next_idx);
                         parents.push_back(search_idx);
-                        covered.insert(next_idx);
+                        visit(next_idx);
                     }
                 }
             }
@@ -109,7 +189,7 @@ void RoomGenerator::find_path(int src, int dst, std::vector<int> &path) {
         search_idx++;
     }
 
-    if (expanded[search_idx] == dst) {
+    if (search_idx < int(expanded.size()) && expanded[search_idx] == dst) {
         std::vector<int> tmp;
 
         while (search_idx >= 0) {
@@ -123,35 +203,51 @@ void RoomGenerator::find_path(int src, int dst, std::vector<int> &path) {
     }
 }
 
+/*
+  Rooms are disjoint, so one epoch marks the cells of every room found so far
+*/
 void RoomGenerator::find_best_room(std::set<int> &best_room) {
-    std::set<int> all_rooms;
-    all_rooms.clear();
+    std::vector<int> room;
+    std::vector<int> best_cells;
     best_room.clear();
 
     int best_room_size = -1;
 
+    start_visit();
+
     for (int i = 0; i < game->grid_size; i++) {
-        if (game->get_obj(i) == SPACE && !set_contains(all_rooms, i)) {
-            std::set<int> next_room;
-            build_room(i, next_room);
-            all_rooms.insert(next_room.begin(), next_room.end());
-
-            if (int(next_room.size()) > best_room_size) {
-                best_room_size = (int)(next_room.size());
-                best_room = next_room;
+        if (game->get_obj(i) == SPACE && !visited(i)) {
+            room.clear();
+            build_room(i, room);
+
+            if (int(room.size()) > best_room_size) {
+                best_room_size = (int)(room.size());
+                best_cells.swap(room);
             }
         }
     }
+
+    std::sort(best_cells.begin(), best_cells.end());
+    best_room.insert(best_cells.begin(), best_cells.end());
 }
 
 void RoomGenerator::expand_room(std::set<int> &set, int n) {
-    std::set<int> curr_set;
-    curr_set.insert(set.begin(), set.end());
+    std::vector<int> curr_cells(set.begin(), set.end());
+    std::vector<int> next_cells;
+    std::vector<int> added;
+
+    start_visit();
+
+    for (int idx : set) {
+        if (0 <= idx && idx < game->grid_size) {
+            visit(idx);
+        }
+    }
 
     for (int loop = 0; loop < n; loop++) {
-        std::set<int> next;
+        next_cells.clear();
 
-        for (int curr_idx : curr_set) {
+        for (int curr_idx : curr_cells) {
             if (game->get_obj(curr_idx) != SPACE)
                 continue;
 
@@ -160,18 +256,22 @@ void RoomGenerator::expand_room(std::set<int> &set, int n) {
 
             for (int i = -1; i <= 1; i++) {
                 for (int j = -1; j <= 1; j++) {
-                    if (i != 0 || j != 0) {
+                    if ((i != 0 || j != 0) && is_space(x + i, y + j)) {
                         int next_idx = game->to_grid_idx(x + i, y + j);
 
-                        if (!set_contains(set, next_idx) && game->get_obj(next_idx) == SPACE) {
-                            set.insert(next_idx);
-                            next.insert(next_idx);
+                        if (!visited(next_idx)) {
+                            visit(next_idx);
+                            next_cells.push_back(next_idx);
+                            added.push_back(next_idx);
                         }
                     }
                 }
             }
         }
 
-        curr_set = next;
+        curr_cells.swap(next_cells);
     }
+
+    std::sort(added.begin(), added.end());
+    set.insert(added.begin(), added.end());
 }
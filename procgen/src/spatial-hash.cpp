@@ -0,0 +1,196 @@
+#include "spatial-hash.h"
+#include "cpp-utils.h"
+#include <algorithm>
+#include <math.h>
+
+// pad cell ranges so that rounding in x - rx can never drop a cell that the exact collision test would touch
+const float CELL_PAD = 1e-3f;
+// entities covering more cells than this are kept in a list that is part of every query result
+const int MAX_ENTITY_CELLS = 16;
+// queries covering more cells than this return every entity
+const int MAX_QUERY_CELLS = 256;
+// positions beyond this are treated like infinitely large entities
+const float MAX_COORD = 1e6f;
+const size_t MIN_BUCKETS = 64;
+
+static bool cell_range(float x, float y, float hx, float hy, int *min_x, int *min_y, int *max_x, int *max_y) {
+    if (!(fabs(x) < MAX_COORD && fabs(y) < MAX_COORD && hx < MAX_COORD && hy < MAX_COORD)) {
+        return false;
+    }
+
+    *min_x = (int)(floor(x - hx - CELL_PAD));
+    *max_x = (int)(floor(x + hx + CELL_PAD));
+    *min_y = (int)(floor(y - hy - CELL_PAD));
+    *max_y = (int)(floor(y + hy + CELL_PAD));
+
+    return true;
+}
+
+void SpatialHash::clear() {
+    slots.clear();
+    oversized.clear();
+
+    for (auto &bucket : buckets) {
+        bucket.clear();
+    }
+}
+
+void SpatialHash::set_slot(Slot &slot, const EntityStore &store, int idx) {
+    slot.handle = store.handles[idx];
+    slot.oversized = !cell_range(store.x[idx], store.y[idx], store.rx[idx], store.ry[idx], &slot.min_x, &slot.min_y, &slot.max_x, &slot.max_y);
+
+    if (!slot.oversized) {
+        int64_t num_cells = (int64_t)(slot.max_x - slot.min_x + 1) * (slot.max_y - slot.min_y + 1);
+        slot.oversized = num_cells > MAX_ENTITY_CELLS;
+    }
+}
+
+std::vector<int> &SpatialHash::bucket_for(int cx, int cy) {
+    uint32_t h = ((uint32_t)(cx)*73856093u) ^ ((uint32_t)(cy)*19349663u);
+    return buckets[h & (buckets.size() - 1)];
+}
+
+void SpatialHash::insert(int idx) {
+    const Slot &slot = slots[idx];
+
+    if (slot.oversized) {
+        oversized.push_back(idx);
+        return;
+    }
+
+    for (int cx = slot.min_x; cx <= slot.max_x; cx++) {
+        for (int cy = slot.min_y; cy <= slot.max_y; cy++) {
+            bucket_for(cx, cy).push_back(idx);
+        }
+    }
+}
+
+static void swap_remove(std::vector<int> &elems, int elem) {
+    auto it = std::find(elems.begin(), elems.end(), elem);
+    fassert(it != elems.end());
+    *it = elems.back();
+    elems.pop_back();
+}
+
+void SpatialHash::remove(int idx) {
+    const Slot &slot = slots[idx];
+
+    if (slot.oversized) {
+        swap_remove(oversized, idx);
+        return;
+    }
+
+    for (int cx = slot.min_x; cx <= slot.max_x; cx++) {
+        for (int cy = slot.min_y; cy <= slot.max_y; cy++) {
+            swap_remove(bucket_for(cx, cy), idx);
+        }
+    }
+}
+
+void SpatialHash::rehash(size_t num_buckets) {
+    oversized.clear();
+    buckets.clear();
+    buckets.resize(num_buckets);
+
+    for (int i = 0; i < (int)(slots.size()); i++) {
+        insert(i);
+    }
+}
+
+void SpatialHash::sync(const EntityStore &store) {
+    int num_entities = store.size();
+
+    while ((int)(slots.size()) > num_entities) {
+        remove((int)(slots.size()) - 1);
+        slots.pop_back();
+    }
+
+    size_t num_buckets = MIN_BUCKETS;
+    while (num_buckets < 4 * (size_t)(num_entities)) {
+        num_buckets *= 2;
+    }
+
+    if (buckets.size() < num_buckets) {
+        rehash(num_buckets);
+    }
+
+    for (int i = 0; i < num_entities; i++) {
+        if (i == (int)(slots.size())) {
+            slots.emplace_back();
+            set_slot(slots[i], store, i);
+            insert(i);
+            continue;
+        }
+
+        update(store, i);
+    }
+}
+
+void SpatialHash::update(const EntityStore &store, int idx) {
+    Slot &slot = slots[idx];
+    Slot updated;
+    set_slot(updated, store, idx);
+
+    bool unchanged = slot.handle == updated.handle && slot.oversized == updated.oversized &&
+                     (slot.oversized || (slot.min_x == updated.min_x && slot.max_x == updated.max_x && slot.min_y == updated.min_y && slot.max_y == updated.max_y));
+
+    if (!unchanged) {
+        remove(idx);
+        slot = updated;
+        insert(idx);
+    }
+}
+
+void SpatialHash::query(float x, float y, float hx, float hy, std::vector<int> &result) {
+    result.clear();
+
+    int min_x, min_y, max_x, max_y;
+    bool bounded = cell_range(x, y, fmax(hx, 0), fmax(hy, 0), &min_x, &min_y, &max_x, &max_y);
+
+    if (!bounded || (int64_t)(max_x - min_x + 1) * (max_y - min_y + 1) > MAX_QUERY_CELLS) {
+        for (int i = (int)(slots.size()) - 1; i >= 0; i--) {
+            result.push_back(i);
+        }
+        return;
+    }
+
+    epoch++;
+    if (epoch == 0) {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        epoch = 1;
+    }
+    stamps.resize(slots.size(), 0);
+
+    auto add = [&](int idx) {
+        if (stamps[idx] != epoch) {
+            stamps[idx] = epoch;
+            result.push_back(idx);
+        }
+    };
+
+    for (int cx = min_x; cx <= max_x; cx++) {
+        for (int cy = min_y; cy <= max_y; cy++) {
+            for (int idx : bucket_for(cx, cy)) {
+                add(idx);
+            }
+        }
+    }
+
+    for (int idx : oversized) {
+        add(idx);
+    }
+
+    std::sort(result.begin(), result.end(), std::greater<int>());
+}
+
+size_t SpatialHash::memory_bytes() const {
+    size_t bytes = slots.capacity() * sizeof(Slot) + buckets.capacity() * sizeof(std::vector<int>);
+
+    for (const auto &bucket : buckets) {
+        bytes += bucket.capacity() * sizeof(int);
+    }
+
+    bytes += oversized.capacity() * sizeof(int) + stamps.capacity() * sizeof(uint32_t);
+
+    return bytes;
+}
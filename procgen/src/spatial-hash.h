@@ -0,0 +1,51 @@
+#pragma once
+
+/*
+
+Broadphase for entity collisions, entities are bucketed by the integer world cells their rect overlaps
+
+Game code moves entities by writing to their fields directly, so the hash cannot observe moves as they
+happen. sync() compares every entity in a freshly synced EntityStore against the cells it was last indexed
+under and only re-buckets the entities whose cells changed. Code that knows which entity it moved, such as
+the stepping loops in BasicAbstractGame, calls update() for just that entity instead.
+
+*/
+
+#include <vector>
+#include "entity-store.h"
+
+class SpatialHash {
+  public:
+    void clear();
+    void sync(const EntityStore &store);
+    // re-buckets entity idx after its row in store changed, the rest of store must be unchanged since sync
+    void update(const EntityStore &store, int idx);
+
+    // indices of the entities whose rect may overlap the rect centered at (x, y) with half extents (hx, hy),
+    // in descending order. This is a superset, callers still need to test for an actual collision.
+    void query(float x, float y, float hx, float hy, std::vector<int> &result);
+
+    size_t memory_bytes() const;
+
+  private:
+    struct Slot {
+        EntityHandle handle;
+        int min_x = 0;
+        int min_y = 0;
+        int max_x = 0;
+        int max_y = 0;
+        bool oversized = false;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<std::vector<int>> buckets;
+    std::vector<int> oversized;
+    std::vector<uint32_t> stamps;
+    uint32_t epoch = 0;
+
+    void set_slot(Slot &slot, const EntityStore &store, int idx);
+    void insert(int idx);
+    void remove(int idx);
+    void rehash(size_t num_buckets);
+    std::vector<int> &bucket_for(int cx, int cy);
+};
@@ -2,6 +2,12 @@
 #include "cpp-utils.h"
 #include "vecoptions.h"
 #include "game.h"
+#include "grid-batch.h"
+#include "level-cache.h"
+#include "level-sampler.h"
+#include "level-sweep.h"
+#include <algorithm>
+#include <cstring>
 
 extern void coinrun_old_init(int rand_seed);
 
@@ -55,6 +61,39 @@ int libenv_all_episodes_done(libenv_venv *env, bool *all_episodes_done){
   return all_done.size();
 }
 
+int libenv_get_memory_stats(libenv_venv *env, struct libenv_memory_stat *stats, int capacity) {
+    auto venv = (VecGame *)(env);
+    auto all_stats = venv->memory_stats();
+    if (stats != nullptr) {
+        int count = std::min(capacity, (int)(all_stats.size()));
+        for (int i = 0; i < count; i++) {
+            stats[i] = all_stats[i];
+        }
+    }
+    return (int)(all_stats.size());
+}
+
+void libenv_get_level_cache_stats(libenv_venv *env, struct libenv_level_cache_stats *stats) {
+    (void)env;
+    LevelCacheStats cache_stats = LevelCache::shared().stats();
+    stats->hits = cache_stats.hits;
+    stats->misses = cache_stats.misses;
+    stats->evictions = cache_stats.evictions;
+    stats->levels = cache_stats.levels;
+    stats->bytes = cache_stats.bytes;
+    stats->capacity_bytes = cache_stats.capacity_bytes;
+}
+
+void libenv_update_level_scores(libenv_venv *env, const int32_t *level_seeds, const float *scores, int count) {
+    auto venv = (VecGame *)(env);
+    venv->update_level_scores(level_seeds, scores, count);
+}
+
+int libenv_get_level_sweep_results(libenv_venv *env, float *returns, int32_t *lengths, uint8_t *level_complete) {
+    auto venv = (VecGame *)(env);
+    return venv->get_level_sweep_results(returns, lengths, level_complete);
+}
+
 int libenv_get_spaces(libenv_venv *env, enum libenv_spaces_name name,
                       struct libenv_space *out_spaces) {
     auto venv = (VecGame *)(env);
@@ -92,6 +131,14 @@ void libenv_reset(libenv_venv *env, struct libenv_step *step) {
     venv->reset(obs);
 }
 
+void libenv_reset_to_seeds(libenv_venv *env, const int32_t *level_seeds, struct libenv_step *step) {
+    auto venv = (VecGame *)(env);
+    std::vector<int32_t> vec_seeds(level_seeds, level_seeds + venv->num_envs);
+    auto obs = convert_bufs(step->obs, venv->num_envs,
+                            venv->observation_spaces.size());
+    venv->reset_to_seeds(vec_seeds, obs);
+}
+
 void libenv_step_async(libenv_venv *env, const void **acts,
                        struct libenv_step *step) {
     auto venv = (VecGame *)(env);
@@ -112,6 +159,12 @@ void libenv_step_wait(libenv_venv *env) {
     venv->step_wait();
 }
 
+void libenv_grid_batch_step(libenv_venv *env, const int32_t *acts, float *rews, uint8_t *dones, uint8_t *level_completes) {
+    auto venv = (VecGame *)(env);
+    std::vector<int32_t> vec_acts(acts, acts + venv->num_envs);
+    venv->grid_batch_step(vec_acts, rews, dones, level_completes);
+}
+
 bool libenv_render(libenv_venv *env, const char *mode, void **frames) {
     auto venv = (VecGame *)(env);
     std::vector<void *> arrays(frames, frames + venv->num_envs);
@@ -149,7 +202,12 @@ static void stepping_worker(std::mutex& stepping_thread_mutex,
             }
         }
 
-        game->step();
+        if (game->pending_reset_seed >= 0) {
+            game->reset_to_level(game->pending_reset_seed);
+            game->pending_reset_seed = -1;
+        } else {
+            game->step();
+        }
 
         {
             std::unique_lock<std::mutex> lock(stepping_thread_mutex);
@@ -196,6 +254,11 @@ VecGame::VecGame(int _nenvs, VecOptions opts) {
     int rand_seed = 0;
     int num_threads = 4;
     std::string resource_root;
+    std::string rand_gen_backend_name = "mt19937";
+    bool use_level_sampler = false;
+    float level_sampler_temperature = 1.0f;
+    float level_sampler_staleness = 0.0f;
+    bool use_level_sweep = false;
 
     opts.consume_string("env_name", &env_name);
     opts.consume_int("num_levels", &num_levels);
@@ -205,6 +268,13 @@ VecGame::VecGame(int _nenvs, VecOptions opts) {
     opts.consume_int("num_threads", &num_threads);
     opts.consume_string("resource_root", &resource_root);
     opts.consume_int_vector("max_episodes_per_game", max_episodes_per_game);
+    opts.consume_string("rand_gen_backend", &rand_gen_backend_name);
+    opts.consume_bool("use_level_sampler", &use_level_sampler);
+    opts.consume_float("level_sampler_temperature", &level_sampler_temperature);
+    opts.consume_float("level_sampler_staleness", &level_sampler_staleness);
+    opts.consume_bool("use_level_sweep", &use_level_sweep);
+
+    RandGenBackend rand_gen_backend = rand_gen_backend_from_name(rand_gen_backend_name);
 
     std::call_once(global_init_flag, global_init, rand_seed,
                    resource_root);
@@ -237,6 +307,19 @@ VecGame::VecGame(int _nenvs, VecOptions opts) {
         level_seed_high = start_level + num_levels;
     }
 
+    if (use_level_sampler) {
+        // the sampler needs a bounded level range
+        fassert(num_levels > 0);
+        level_sampler = std::make_shared<LevelSampler>(level_seed_low, num_levels, level_sampler_temperature, level_sampler_staleness);
+    }
+
+    if (use_level_sweep) {
+        // the sweep decides which level each env plays
+        fassert(num_levels > 0);
+        fassert(!use_level_sampler);
+        level_sweep = std::make_shared<LevelSweep>(level_seed_low, num_levels);
+    }
+
     std::vector<std::string> env_names = split(env_name, ",");
 
     num_joint_games = (int)(env_names.size());
@@ -250,12 +333,18 @@ VecGame::VecGame(int _nenvs, VecOptions opts) {
         auto name = env_names[n % num_joint_games];
 
         games[n] = globalGameRegistry->at(name)();
+        games[n]->level_seed_rand_gen.set_backend(rand_gen_backend);
+        games[n]->rand_gen.set_backend(rand_gen_backend);
         games[n]->level_seed_rand_gen.seed(game_level_seed_gen.randint());
         games[n]->level_seed_high = level_seed_high;
         games[n]->level_seed_low = level_seed_low;
+        games[n]->level_sampler = level_sampler;
+        games[n]->level_sweep = level_sweep;
         games[n]->game_n = n;
         games[n]->is_waiting_for_step = false;
         games[n]->parse_options(name, opts);
+        // sequential levels continue past the end of a level without ending the episode
+        fassert(!(level_sweep && games[n]->options.use_sequential_levels));
 
         // Auto-selected a fixed_asset_seed if one wasn't specified on
         // construction
@@ -364,6 +453,7 @@ void VecGame::reset(const std::vector<std::vector<void *>> &obs) {
     }
     first_reset = false;
     wait_for_stepping_threads();
+    end_grid_batch();
     for (int e = 0; e < num_envs; e++) {
         const auto &game = games[e];
         // game->render_to_buf(game->render_buf, RES_W, RES_H, false);
@@ -373,16 +463,105 @@ void VecGame::reset(const std::vector<std::vector<void *>> &obs) {
         game->reset();
 
     }
+    if (level_sampler != nullptr) {
+        level_sampler->commit_env_samples();
+    }
+}
+
+void VecGame::reset_to_seeds(const std::vector<int32_t> &level_seeds, const std::vector<std::vector<void *>> &obs) {
+    // like step_async, all games belong to this thread until they are handed to the stepping threads
+    wait_for_stepping_threads();
+    end_grid_batch();
+    {
+        std::unique_lock<std::mutex> lock(stepping_thread_mutex);
+
+        for (int e = 0; e < num_envs; e++) {
+            if (level_seeds[e] == -1) {
+                continue;
+            }
+            fassert(level_seeds[e] >= 0);
+
+            const auto &game = games[e];
+            game->connect_obs_buffer(observation_spaces, obs[e]);
+            if (threads.size() == 0) {
+                game->reset_to_level(level_seeds[e]);
+            } else {
+                game->pending_reset_seed = level_seeds[e];
+                game->is_waiting_for_step = true;
+                pending_games.push_back(game);
+            }
+        }
+    }
+
+    pending_games_added.notify_all();
+    wait_for_stepping_threads();
 }
 
 std::vector<bool> VecGame::all_episodes_done(){
   std::vector<bool> all_done;
   for (int e = 0; e < num_envs; e++) {
+      if (games[e]->level_sweep) {
+          all_done.push_back(games[e]->sweep_finished);
+          continue;
+      }
       all_done.push_back(games[e]->get_num_episodes_done() >= max_episodes_per_game[e]);
   }
   return all_done;
 }
 
+std::vector<struct libenv_memory_stat> VecGame::memory_stats() {
+    wait_for_stepping_threads();
+
+    MemoryUsage usage;
+    for (const auto &game : games) {
+        game->memory_usage(usage);
+    }
+
+    std::map<std::string, struct libenv_memory_stat> by_category;
+
+    for (const auto &kv : usage.env_bytes) {
+        by_category[kv.first].per_env_bytes = (int64_t)(kv.second / num_envs);
+    }
+
+    for (const auto &kv : usage.shared_bytes) {
+        int64_t shared = 0;
+        for (const auto &owner_bytes : kv.second) {
+            shared += (int64_t)(owner_bytes.second);
+        }
+        by_category[kv.first].shared_bytes = shared;
+    }
+
+    std::vector<struct libenv_memory_stat> stats;
+    for (auto &kv : by_category) {
+        struct libenv_memory_stat stat = kv.second;
+        strncpy(stat.name, kv.first.c_str(), LIBENV_MAX_NAME_LEN - 1);
+        stat.name[LIBENV_MAX_NAME_LEN - 1] = 0;
+        stats.push_back(stat);
+    }
+
+    return stats;
+}
+
+void VecGame::update_level_scores(const int32_t *level_seeds, const float *scores, int count) {
+    fassert(level_sampler != nullptr);
+    wait_for_stepping_threads();
+    level_sampler->update_scores(level_seeds, scores, count);
+}
+
+int VecGame::get_level_sweep_results(float *returns, int32_t *lengths, uint8_t *level_completes) {
+    fassert(level_sweep != nullptr);
+    // the stepping threads record results as episodes end
+    wait_for_stepping_threads();
+
+    int num_levels = level_sweep->get_num_levels();
+    if (returns != nullptr) {
+        memcpy(returns, level_sweep->returns.data(), num_levels * sizeof(float));
+        memcpy(lengths, level_sweep->lengths.data(), num_levels * sizeof(int32_t));
+        memcpy(level_completes, level_sweep->level_completes.data(), num_levels * sizeof(uint8_t));
+    }
+    return num_levels;
+}
+
 void VecGame::step_async(const std::vector<int32_t> &acts,
                          const std::vector<std::vector<void *>> &obs,
                          const std::vector<std::vector<void *>> &infos,
@@ -390,6 +569,7 @@ void VecGame::step_async(const std::vector<int32_t> &acts,
     // this function should never be called until after creation/step_wait()
     // so at this point, we can be certain that no games are waiting for steps
     // and that all games belong to the python thread
+    end_grid_batch();
     {
         std::unique_lock<std::mutex> lock(stepping_thread_mutex);
 
@@ -398,6 +578,9 @@ void VecGame::step_async(const std::vector<int32_t> &acts,
             if ((max_episodes_per_game[e] > 0) &&  (game->get_num_episodes_done() >= max_episodes_per_game[e])){
               continue;
             }
+            if (game->sweep_finished) {
+                continue;
+            }
             game->action = acts[e];
             game->obs_bufs = obs[e];
             game->info_bufs = infos[e];
@@ -434,23 +617,26 @@ VecGame::~VecGame() {
 }
 
 void VecGame::wait_for_stepping_threads() {
-    if (threads.size() == 0) {
-        return;
-    }
+    if (threads.size() > 0) {
+        std::unique_lock<std::mutex> lock(stepping_thread_mutex);
+        while (1) {
+            bool all_steps_completed = true;
 
-    std::unique_lock<std::mutex> lock(stepping_thread_mutex);
-    while (1) {
-        bool all_steps_completed = true;
+            for (int e = 0; e < num_envs; e++) {
+                const auto &game = games[e];
+                all_steps_completed &= !game->is_waiting_for_step;
+            }
 
-        for (int e = 0; e < num_envs; e++) {
-            const auto &game = games[e];
-            all_steps_completed &= !game->is_waiting_for_step;
-        }
+            if (all_steps_completed)
+                break;
 
-        if (all_steps_completed)
-            break;
+            pending_game_complete.wait(lock);
+        }
+    }
 
-        pending_game_complete.wait(lock);
+    // no env is stepping, so the levels drawn since the last call are applied in env order
+    if (level_sampler != nullptr) {
+        level_sampler->commit_env_samples();
     }
 }
 
@@ -459,10 +645,40 @@ void VecGame::step_wait() {
     // at this point all games belong to the python thread
 }
 
+void VecGame::grid_batch_step(const std::vector<int32_t> &acts, float *rews, uint8_t *dones, uint8_t *level_completes) {
+    wait_for_stepping_threads();
+
+    if (grid_batch == nullptr) {
+        grid_batch = std::make_shared<GridBatch>(*this);
+    }
+
+    // the envs that step_async would skip
+    grid_batch_skip.resize(num_envs);
+    for (int e = 0; e < num_envs; e++) {
+        const auto &game = games[e];
+        bool episodes_done = (max_episodes_per_game[e] > 0) && (game->get_num_episodes_done() >= max_episodes_per_game[e]);
+        grid_batch_skip[e] = episodes_done || game->sweep_finished;
+    }
+
+    grid_batch->step(acts.data(), grid_batch_skip.data(), rews, dones, level_completes);
+}
+
+/*
+  Writes the agent positions and times that GridBatch keeps back to the games, before they are used normally
+*/
+void VecGame::end_grid_batch() {
+    if (grid_batch != nullptr) {
+        grid_batch->sync_games();
+        grid_batch = nullptr;
+    }
+}
+
 bool VecGame::render(const std::string &mode,
                      const std::vector<void *> &arrays) {
     uint8_t render_hires_buf[RENDER_RES * RENDER_RES * 4];
 
+    end_grid_batch();
+
     for (int e = 0; e < num_envs; e++) {
         const auto &game = games[e];
         game->render_to_buf(render_hires_buf, RENDER_RES, RENDER_RES, true);
@@ -16,6 +16,10 @@ This implements the libenv interface and manages a vector of Game instances
 
 class VecOptions;
 class Game;
+class LevelSampler;
+class LevelSweep;
+class GridBatch;
+struct libenv_memory_stat;
 
 class VecGame {
   public:
@@ -31,14 +35,28 @@ class VecGame {
     int num_actions;
 
     std::vector<std::shared_ptr<Game>> games;
+    // set with the use_level_sampler option
+    std::shared_ptr<LevelSampler> level_sampler;
+    // set with the use_level_sweep option
+    std::shared_ptr<LevelSweep> level_sweep;
 
     VecGame(int _nenvs, VecOptions opt_vec);
     ~VecGame();
 
     void reset(const std::vector<std::vector<void *>> &obs);
+    // starts a new episode on level_seeds[e] in every env e where it is not -1, on the stepping threads
+    void reset_to_seeds(const std::vector<int32_t> &level_seeds, const std::vector<std::vector<void *>> &obs);
     void step_async(const std::vector<int32_t> &acts, const std::vector<std::vector<void *>> &obs, const std::vector<std::vector<void *>> &infos, float *rews, uint8_t *dones);
     void step_wait();
+    // steps every env once with GridBatch on this thread, the games go back to normal stepping with the next
+    // reset, reset_to_seeds, step_async or render
+    void grid_batch_step(const std::vector<int32_t> &acts, float *rews, uint8_t *dones, uint8_t *level_completes);
     bool render(const std::string &mode, const std::vector<void *> &arrays);
+    std::vector<struct libenv_memory_stat> memory_stats();
+    // waits for a step in progress, so that the envs drawing levels in it see the scores from before the call
+    void update_level_scores(const int32_t *level_seeds, const float *scores, int count);
+    // copies the level sweep results once a step in progress has finished writing them, returns the number of levels
+    int get_level_sweep_results(float *returns, int32_t *lengths, uint8_t *level_completes);
 
     int add_space(int space_identifier, struct libenv_space *sp);
 
@@ -55,5 +73,9 @@ class VecGame {
     std::vector<int> max_episodes_per_game;
     bool time_to_die = false;
     bool first_reset = true;
+    // set while the games are stepped by grid_batch_step
+    std::shared_ptr<GridBatch> grid_batch;
+    std::vector<uint8_t> grid_batch_skip;
     void wait_for_stepping_threads();
+    void end_grid_batch();
 };
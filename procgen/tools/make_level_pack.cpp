@@ -0,0 +1,113 @@
+/*
+
+Generates a level pack, which envs created with the level_pack option read levels from instead of
+generating them
+
+The options default to the defaults of ProcgenEnv, and must match the options of the envs that will use
+the pack, otherwise those envs fail to start.
+
+usage: make_level_pack --env NAME --num-levels N --out PATH [--start-level N] [--distribution-mode MODE]
+                       [--rand-gen-backend BACKEND] [--use-fast-level-generation] [--no-center-agent]
+                       [--threads N] [--resource-root PATH]
+
+*/
+
+#include "../benchmarks/bench-utils.h"
+#include "../src/cpp-utils.h"
+#include "../src/game.h"
+#include "../src/level-pack.h"
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+
+static int distribution_mode_from_name(const std::string &name) {
+    if (name == "easy") {
+        return EasyMode;
+    } else if (name == "hard") {
+        return HardMode;
+    } else if (name == "extreme") {
+        return ExtremeMode;
+    } else if (name == "memory") {
+        return MemoryMode;
+    }
+    fatal("invalid distribution mode %s\n", name.c_str());
+    return HardMode;
+}
+
+int main(int argc, char **argv) {
+    std::string env_name;
+    std::string out_path;
+    std::string distribution_mode = "hard";
+    std::string rand_gen_backend = "mt19937";
+    std::string resource_root = PROCGEN_ASSETS_DIR;
+    int start_level = 0;
+    int num_levels = 0;
+    int num_threads = (int)(std::thread::hardware_concurrency());
+    bool use_fast_level_generation = false;
+    bool center_agent = true;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--use-fast-level-generation") {
+            use_fast_level_generation = true;
+        } else if (arg == "--no-center-agent") {
+            center_agent = false;
+        } else if (arg == "--env" && has_value) {
+            env_name = argv[++i];
+        } else if (arg == "--out" && has_value) {
+            out_path = argv[++i];
+        } else if (arg == "--start-level" && has_value) {
+            start_level = atoi(argv[++i]);
+        } else if (arg == "--num-levels" && has_value) {
+            num_levels = atoi(argv[++i]);
+        } else if (arg == "--distribution-mode" && has_value) {
+            distribution_mode = argv[++i];
+        } else if (arg == "--rand-gen-backend" && has_value) {
+            rand_gen_backend = argv[++i];
+        } else if (arg == "--threads" && has_value) {
+            num_threads = atoi(argv[++i]);
+        } else if (arg == "--resource-root" && has_value) {
+            resource_root = argv[++i];
+        } else {
+            fatal("unknown argument %s\n", arg.c_str());
+        }
+    }
+
+    if (env_name.empty() || out_path.empty() || num_levels <= 0) {
+        fatal("usage: make_level_pack --env NAME --num-levels N --out PATH [--start-level N]\n");
+    }
+    if (resource_root.back() != '/') {
+        resource_root += "/";
+    }
+    num_threads = std::max(num_threads, 1);
+
+    Options opts;
+    opts.add_string("env_name", env_name);
+    opts.add_int("num_levels", num_levels);
+    opts.add_int("start_level", start_level);
+    opts.add_int("num_actions", 15);
+    opts.add_int("num_threads", 0);
+    opts.add_int("rand_seed", 0);
+    opts.add_int("distribution_mode", distribution_mode_from_name(distribution_mode));
+    opts.add_string("rand_gen_backend", rand_gen_backend);
+    opts.add_bool("center_agent", center_agent);
+    opts.add_bool("use_fast_level_generation", use_fast_level_generation);
+    // generated assets draw a new background on every reset, which level packs do not support
+    opts.add_bool("use_generated_assets", false);
+    opts.add_string("resource_root", resource_root);
+
+    // one game per thread, each generates levels in turn
+    VecGame venv(num_threads, VecOptions(opts.get()));
+
+    auto start = std::chrono::steady_clock::now();
+    write_level_pack(out_path, venv.games, start_level, num_levels);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    auto pack = LevelPack::open(out_path);
+    printf("wrote %d %s levels to %s, %.1f MB in %.2f sec\n", num_levels, env_name.c_str(), out_path.c_str(), pack->size_bytes() / 1e6, elapsed.count());
+
+    return 0;
+}